@@ -0,0 +1,143 @@
+// Microbenchmarks for the Engine state machine against the in-memory backends.
+//
+// Every case is swept over {LEVEL0 grid, LEVEL1 grid, MAX_RECURSION_DEPTH}.
+// Each iteration brings a batch of engines into the mode under test, untimed,
+// then times one call on each. Time is per batch; the ns_per_call counter
+// and items_per_second give the per-call figures. The mock overlay
+// confirms geometry immediately, so no settle wait is included.
+//
+// JSON output: EngineBench --benchmark_out=EngineBench.json --benchmark_out_format=json
+// (or `cmake --build . --target engine_bench_json`).
+
+#include <benchmark/benchmark.h>
+#include "../src/core/Engine.h"
+#include "../src/core/Config.h"
+#include "../src/core/Logger.h"
+#include "../tests/Mocks.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr int BATCH = 256;
+
+struct BenchEngine {
+    Engine engine;
+    MockPlatform platform;
+    MockOverlay overlay;
+    MockInput input;
+
+    BenchEngine() {
+        engine.setPlatform(&platform);
+        engine.setOverlay(&overlay);
+        engine.setInput(&input);
+        engine.initialize();
+    }
+
+    // Fresh activation, then `keys` characters.
+    void reach(const char* keys) {
+        engine.onDeactivate();
+        engine.onActivate();
+        for (const char* k = keys; *k; ++k) engine.onChar(*k, false);
+    }
+
+    // Level1_Recursive with `depth` refinements already applied.
+    void reachLevel1(int depth) {
+        reach("aa");
+        for (int i = 0; i < depth; ++i) engine.onChar('a', false);
+    }
+};
+
+void applyArgs(const benchmark::State& state) {
+    Config::LEVEL0_GRID_ROWS = Config::LEVEL0_GRID_COLS = (int)state.range(0);
+    Config::LEVEL1_GRID_ROWS = Config::LEVEL1_GRID_COLS = (int)state.range(1);
+    Config::MAX_RECURSION_DEPTH = (int)state.range(2);
+}
+
+template<typename Setup, typename Op>
+void runBatched(benchmark::State& state, Setup setup, Op op) {
+    applyArgs(state);
+    std::vector<std::unique_ptr<BenchEngine>> engines;
+    for (int i = 0; i < BATCH; ++i) engines.push_back(std::make_unique<BenchEngine>());
+
+    double totalSeconds = 0.0;
+    for (auto _ : state) {
+        for (auto& e : engines) setup(*e);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (auto& e : engines) op(*e);
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        state.SetIterationTime(elapsed);
+        totalSeconds += elapsed;
+    }
+
+    const double calls = (double)state.iterations() * BATCH;
+    state.SetItemsProcessed((int64_t)calls);
+    state.counters["ns_per_call"] = calls > 0 ? totalSeconds * 1e9 / calls : 0.0;
+}
+
+void BM_Activate(benchmark::State& state) {
+    runBatched(state,
+        [](BenchEngine& e) { e.engine.onDeactivate(); },
+        [](BenchEngine& e) { e.engine.onActivate(); });
+}
+
+void BM_Char_Level0First(benchmark::State& state) {
+    runBatched(state,
+        [](BenchEngine& e) { e.reach(""); },
+        [](BenchEngine& e) { e.engine.onChar('b', false); });
+}
+
+void BM_Char_Level0Second(benchmark::State& state) {
+    runBatched(state,
+        [](BenchEngine& e) { e.reach("b"); },
+        [](BenchEngine& e) { e.engine.onChar('c', false); });
+}
+
+void BM_Char_Level1(benchmark::State& state) {
+    const int depth = (int)state.range(2) - 1; // Last refinement before the target point
+    runBatched(state,
+        [depth](BenchEngine& e) { e.reachLevel1(depth); },
+        [](BenchEngine& e) { e.engine.onChar('b', false); });
+}
+
+void BM_Undo(benchmark::State& state) {
+    const int depth = (int)state.range(2);
+    runBatched(state,
+        [depth](BenchEngine& e) { e.reachLevel1(depth); },
+        [](BenchEngine& e) { e.engine.onUndo(); });
+}
+
+void BM_UpdateOverlay(benchmark::State& state) {
+    runBatched(state,
+        [](BenchEngine& e) { if (e.input.grabbed) return; e.reach(""); },
+        [](BenchEngine& e) { e.engine.updateOverlay(); });
+}
+
+void gridSweep(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"level0", "level1", "depth"});
+    b->ArgsProduct({{6, 11, 26}, {3, 6, 9}, {1, 2, 3}});
+    b->UseManualTime();
+}
+
+} // namespace
+
+BENCHMARK(BM_Activate)->Apply(gridSweep);
+BENCHMARK(BM_Char_Level0First)->Apply(gridSweep);
+BENCHMARK(BM_Char_Level0Second)->Apply(gridSweep);
+BENCHMARK(BM_Char_Level1)->Apply(gridSweep);
+BENCHMARK(BM_Undo)->Apply(gridSweep);
+BENCHMARK(BM_UpdateOverlay)->Apply(gridSweep);
+
+int main(int argc, char** argv) {
+    // Activation and click paths log at INFO; keep stdout I/O out of the timings.
+    Logger::getInstance().setLevel(LogLevel::WARNING);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,229 @@
+// Headless benchmarks for GridRenderer on ARGB32 image surfaces.
+//
+// Every case is swept over the surface height {1080, 1440, 2160, 4320} at
+// 16:9 and over the grid configurations the overlays draw: a level-0 grid
+// of {6, 11, 26} squared cells covering the surface, and a level-1 grid of
+// {3, 6, 9} squared cells inside the centre cell of an 11x11 level-0 grid.
+// One iteration is one stage of one frame; the fps counter is how many of
+// them fit in a second. Caches are warm unless the case says Cold.
+//
+// The static layer has three paths: Cairo rasterisation (LayerUncached),
+// blending a cached copy as on Xlib targets (LayerCached), and GridCompositor
+// span fills as on image surfaces (LayerSpans). SpanFill times the span
+// kernel alone, per SIMD variant, over one 4K row.
+//
+// JSON output: RenderBench --benchmark_out=RenderBench.json --benchmark_out_format=json
+// (or `cmake --build . --target render_bench_json`).
+
+#include <benchmark/benchmark.h>
+#include "../src/render/GridCompositor.h"
+#include "../src/render/GridRenderer.h"
+#include "../src/render/SpanFill.h"
+#include "../src/core/Logger.h"
+#include <cairo.h>
+#include <vector>
+
+namespace {
+
+constexpr int LEVEL1_PARENT_GRID = 11;
+
+struct BenchSurface {
+    int width;
+    int height;
+    cairo_surface_t* surface;
+    cairo_t* cr;
+
+    explicit BenchSurface(const benchmark::State& state)
+        : width((int)state.range(0) * 16 / 9),
+          height((int)state.range(0)),
+          surface(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height)),
+          cr(cairo_create(surface)) {}
+
+    ~BenchSurface() {
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+    }
+
+    BenchSurface(const BenchSurface&) = delete;
+    BenchSurface& operator=(const BenchSurface&) = delete;
+
+    // The layout of the configuration under test, in surface coordinates
+    GridLayout layout(const benchmark::State& state) const {
+        const int cells = (int)state.range(1);
+        const Rect full{0.0, 0.0, (double)width, (double)height};
+        if (state.range(2) == 0) return GridLayout(full, cells, cells);
+
+        const GridLayout parent(full, LEVEL1_PARENT_GRID, LEVEL1_PARENT_GRID);
+        return GridLayout(parent.cell(parent.cellCount() / 2), cells, cells);
+    }
+
+    // What the overlays do before drawing: clip to the drawn area and clear it
+    void beginFrame(const GridFrame& frame) {
+        const Rect area = GridRenderer::drawnExtent(frame);
+        cairo_save(cr);
+        cairo_rectangle(cr, area.x, area.y, area.w, area.h);
+        cairo_clip(cr);
+        cairo_save(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_restore(cr);
+    }
+
+    void endFrame() {
+        cairo_restore(cr);
+        cairo_surface_flush(surface);
+    }
+};
+
+void report(benchmark::State& state) {
+    state.counters["fps"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+}
+
+void BM_Fit(benchmark::State& state) {
+    BenchSurface target(state);
+    const GridLayout layout = target.layout(state);
+    for (auto _ : state) {
+        GridFrame frame{layout, false};
+        GridRenderer::fitToSurface(frame.layout, target.width, target.height);
+        benchmark::DoNotOptimize(GridRenderer::drawnExtent(frame));
+    }
+    report(state);
+}
+
+void BM_Clear(benchmark::State& state) {
+    BenchSurface target(state);
+    const GridFrame frame{target.layout(state), false};
+    for (auto _ : state) {
+        target.beginFrame(frame);
+        target.endFrame();
+    }
+    report(state);
+}
+
+void BM_LayerUncached(benchmark::State& state) {
+    BenchSurface target(state);
+    const GridLayout layout = target.layout(state);
+    for (auto _ : state) {
+        GridRenderer::drawLayerUncached(target.cr, layout);
+        cairo_surface_flush(target.surface);
+    }
+    report(state);
+}
+
+void BM_LayerCached(benchmark::State& state) {
+    BenchSurface target(state);
+    const GridLayout layout = target.layout(state);
+    GridLayerCache cache;
+    cache.paint(target.cr, layout, GridRenderer::drawLayerUncached);
+    for (auto _ : state) {
+        cache.paint(target.cr, layout, GridRenderer::drawLayerUncached);
+        cairo_surface_flush(target.surface);
+    }
+    report(state);
+}
+
+void BM_LayerSpans(benchmark::State& state) {
+    BenchSurface target(state);
+    const GridLayout layout = target.layout(state);
+    for (auto _ : state) {
+        GridCompositor::drawLayer(target.cr, layout);
+    }
+    report(state);
+}
+
+void BM_Labels(benchmark::State& state) {
+    BenchSurface target(state);
+    const GridLayout layout = target.layout(state);
+    GridRenderer renderer;
+    renderer.drawLabels(target.cr, layout);
+    for (auto _ : state) {
+        renderer.drawLabels(target.cr, layout);
+        cairo_surface_flush(target.surface);
+    }
+    report(state);
+}
+
+void BM_Point(benchmark::State& state) {
+    BenchSurface target(state);
+    const GridFrame frame{target.layout(state), true};
+    GridRenderer renderer;
+    for (auto _ : state) {
+        target.beginFrame(frame);
+        renderer.draw(target.cr, frame);
+        target.endFrame();
+    }
+    report(state);
+}
+
+void BM_Frame(benchmark::State& state) {
+    BenchSurface target(state);
+    const GridFrame frame{target.layout(state), false};
+    GridRenderer renderer;
+    renderer.draw(target.cr, frame);
+    for (auto _ : state) {
+        target.beginFrame(frame);
+        renderer.draw(target.cr, frame);
+        target.endFrame();
+    }
+    report(state);
+}
+
+// First frame of a configuration: layer and labels are rendered from scratch
+void BM_FrameCold(benchmark::State& state) {
+    BenchSurface target(state);
+    const GridFrame frame{target.layout(state), false};
+    for (auto _ : state) {
+        GridRenderer renderer;
+        target.beginFrame(frame);
+        renderer.draw(target.cr, frame);
+        target.endFrame();
+    }
+    report(state);
+}
+
+void BM_SpanFill(benchmark::State& state) {
+    const SpanFill::Impl impl = (SpanFill::Impl)state.range(0);
+    if (!SpanFill::supported(impl)) {
+        state.SkipWithError("not supported by this CPU");
+        return;
+    }
+    state.SetLabel(SpanFill::name(impl));
+    std::vector<uint32_t> row(3840, 0x80404040u);
+    const uint32_t color = SpanFill::premultiply(0.2, 0.5, 0.9, 0.3);
+    for (auto _ : state) {
+        SpanFill::fillOver(impl, row.data(), (int)row.size(), color);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)row.size());
+}
+
+void renderSweep(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"height", "cells", "level"});
+    b->ArgsProduct({{1080, 1440, 2160, 4320}, {6, 11, 26}, {0}});
+    b->ArgsProduct({{1080, 1440, 2160, 4320}, {3, 6, 9}, {1}});
+    b->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace
+
+BENCHMARK(BM_Fit)->Apply(renderSweep);
+BENCHMARK(BM_Clear)->Apply(renderSweep);
+BENCHMARK(BM_LayerUncached)->Apply(renderSweep);
+BENCHMARK(BM_LayerCached)->Apply(renderSweep);
+BENCHMARK(BM_LayerSpans)->Apply(renderSweep);
+BENCHMARK(BM_Labels)->Apply(renderSweep);
+BENCHMARK(BM_Point)->Apply(renderSweep);
+BENCHMARK(BM_Frame)->Apply(renderSweep);
+BENCHMARK(BM_FrameCold)->Apply(renderSweep);
+BENCHMARK(BM_SpanFill)->ArgName("impl")->DenseRange(0, 2);
+
+int main(int argc, char** argv) {
+    // The caches log every miss at DEBUG; keep stdout I/O out of the timings.
+    Logger::getInstance().setLevel(LogLevel::WARNING);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
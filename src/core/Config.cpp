@@ -14,13 +14,35 @@ namespace Config {
     int MAX_RECURSION_DEPTH = 1;
 
     double OVERLAY_BOUNDS_EPSILON = 3.0;
-    std::chrono::milliseconds OVERLAY_SETTLE_POLL_INTERVAL(8);
-    int OVERLAY_SETTLE_MAX_RETRIES = 12;
+    std::chrono::milliseconds OVERLAY_SETTLE_TIMEOUT(100);
     std::chrono::milliseconds POST_UNGRAB_DELAY(50);
     std::chrono::milliseconds CLICK_PRESS_RELEASE_DELAY(40);
     std::chrono::milliseconds DOUBLE_CLICK_DELAY(50);
+    bool CURSOR_GLIDE = false;
+    std::chrono::milliseconds CURSOR_GLIDE_DURATION(120);
 
     double OVERLAY_FILL_ALPHA = 0.30;
+    bool OVERLAY_PRERENDER = true;
+    bool OVERLAY_STANDBY = false;
+    bool OVERLAY_SHM = true;
+    std::string WAYLAND_OVERLAY = "gtk";
+
+    std::string KEYBOARD_LAYOUT = "qwerty";
+    std::string BIND_LEFT_CLICK = "space";
+    std::string BIND_RIGHT_CLICK = "enter";
+    std::string BIND_UNDO = "backspace";
+    std::string BIND_DEACTIVATE = "escape";
+    std::string BIND_STAY_CLICK = "delete";
+    std::string BIND_PRECISION = "tab";
+    std::string BIND_MOVE_LEFT = "left";
+    std::string BIND_MOVE_RIGHT = "right";
+    std::string BIND_MOVE_UP = "up";
+    std::string BIND_MOVE_DOWN = "down";
+
+    double PRECISION_MIN_SPEED = 40.0;
+    double PRECISION_MAX_SPEED = 1200.0;
+    std::chrono::milliseconds PRECISION_RAMP(800);
+    double PRECISION_CURVE = 2.0;
     
     std::vector<Rgba> PALETTE = {
         {0.91, 0.30, 0.27, 0.0}, // coral
@@ -75,6 +97,30 @@ namespace Config {
                 else if (key == "level1_cols") LEVEL1_GRID_COLS = std::stoi(val);
                 else if (key == "max_recursion") MAX_RECURSION_DEPTH = std::stoi(val);
                 else if (key == "overlay_alpha") OVERLAY_FILL_ALPHA = std::stod(val);
+                else if (key == "click_press_release_ms") CLICK_PRESS_RELEASE_DELAY = std::chrono::milliseconds(std::stoi(val));
+                else if (key == "double_click_delay_ms") DOUBLE_CLICK_DELAY = std::chrono::milliseconds(std::stoi(val));
+                else if (key == "cursor_glide") CURSOR_GLIDE = (val == "true" || val == "1");
+                else if (key == "cursor_glide_ms") CURSOR_GLIDE_DURATION = std::chrono::milliseconds(std::stoi(val));
+                else if (key == "overlay_standby") OVERLAY_STANDBY = (val == "true" || val == "1");
+                else if (key == "overlay_prerender") OVERLAY_PRERENDER = (val == "true" || val == "1");
+                else if (key == "overlay_shm") OVERLAY_SHM = (val == "true" || val == "1");
+                else if (key == "wayland_overlay") WAYLAND_OVERLAY = val;
+                else if (key == "keyboard_layout") KEYBOARD_LAYOUT = val;
+                else if (key == "bind_left_click") BIND_LEFT_CLICK = val;
+                else if (key == "bind_right_click") BIND_RIGHT_CLICK = val;
+                else if (key == "bind_undo") BIND_UNDO = val;
+                else if (key == "bind_deactivate") BIND_DEACTIVATE = val;
+                else if (key == "bind_stay_click") BIND_STAY_CLICK = val;
+                else if (key == "bind_precision") BIND_PRECISION = val;
+                else if (key == "bind_move_left") BIND_MOVE_LEFT = val;
+                else if (key == "bind_move_right") BIND_MOVE_RIGHT = val;
+                else if (key == "bind_move_up") BIND_MOVE_UP = val;
+                else if (key == "bind_move_down") BIND_MOVE_DOWN = val;
+                else if (key == "precision_min_speed") PRECISION_MIN_SPEED = std::stod(val);
+                else if (key == "precision_max_speed") PRECISION_MAX_SPEED = std::stod(val);
+                else if (key == "precision_ramp_ms") PRECISION_RAMP = std::chrono::milliseconds(std::stoi(val));
+                else if (key == "precision_curve") PRECISION_CURVE = std::stod(val);
+                else if (key == "overlay_settle_timeout_ms") OVERLAY_SETTLE_TIMEOUT = std::chrono::milliseconds(std::stoi(val));
             } catch (const std::exception& e) {
                 LOG_ERROR("Failed to parse config key '", key, "': ", e.what());
             }
@@ -2,6 +2,7 @@
 #define CONFIG_H
 
 #include <chrono>
+#include <string>
 #include <vector>
 
 namespace Config {
@@ -19,16 +20,62 @@ namespace Config {
     extern double OVERLAY_BOUNDS_EPSILON;
 
     // Timing
-    extern std::chrono::milliseconds OVERLAY_SETTLE_POLL_INTERVAL;
-    extern int OVERLAY_SETTLE_MAX_RETRIES;
+    // Upper bound on waiting for the overlay's settled geometry after show()
+    extern std::chrono::milliseconds OVERLAY_SETTLE_TIMEOUT;
 
     extern std::chrono::milliseconds POST_UNGRAB_DELAY;
 
     extern std::chrono::milliseconds CLICK_PRESS_RELEASE_DELAY;
     extern std::chrono::milliseconds DOUBLE_CLICK_DELAY;
 
+    // Glide the pointer to each target over CURSOR_GLIDE_DURATION, one move
+    // per display refresh, instead of jumping there
+    extern bool CURSOR_GLIDE;
+    extern std::chrono::milliseconds CURSOR_GLIDE_DURATION;
+
     // UI Styling
     extern double OVERLAY_FILL_ALPHA;
+
+    // Keep the overlay mapped (transparent, input-transparent) while idle, so
+    // activation is a content update rather than a map
+    extern bool OVERLAY_STANDBY;
+
+    // Render the Level1 grids reachable from the chosen row in the background
+    extern bool OVERLAY_PRERENDER;
+
+    // Render the X11 overlay client-side into MIT-SHM buffers and present
+    // with XShmPutImage; falls back to Xlib drawing when SHM is unavailable
+    extern bool OVERLAY_SHM;
+
+    // Wayland overlay backend with --evdev: "gtk" (gtk-layer-shell) or
+    // "shm" (libwayland-client and wl_shm directly, no GTK)
+    extern std::string WAYLAND_OVERLAY;
+
+    // Keys (see Keymap): the layout printed on the keyboard, which --evdev
+    // needs to label key positions ("qwerty", "qwertz", "azerty", "dvorak",
+    // "colemak"), and the key for each action while the grid is up. A letter
+    // or digit bound to an action stops picking the cells it labels.
+    extern std::string KEYBOARD_LAYOUT;
+    extern std::string BIND_LEFT_CLICK;
+    extern std::string BIND_RIGHT_CLICK;
+    extern std::string BIND_UNDO;
+    extern std::string BIND_DEACTIVATE;
+    extern std::string BIND_STAY_CLICK;
+    extern std::string BIND_PRECISION;
+    extern std::string BIND_MOVE_LEFT;
+    extern std::string BIND_MOVE_RIGHT;
+    extern std::string BIND_MOVE_UP;
+    extern std::string BIND_MOVE_DOWN;
+
+    // Precision mode: held direction keys (or h/j/k/l) move the pointer at
+    // PRECISION_MIN_SPEED px/s, rising to PRECISION_MAX_SPEED over
+    // PRECISION_RAMP along (held / ramp) ^ PRECISION_CURVE. BIND_PRECISION
+    // toggles it from Level1; at MAX_RECURSION_DEPTH, press it while the
+    // final key is still held, as releasing that key deactivates
+    extern double PRECISION_MIN_SPEED;
+    extern double PRECISION_MAX_SPEED;
+    extern std::chrono::milliseconds PRECISION_RAMP;
+    extern double PRECISION_CURVE;
     
     struct Rgba { double r, g, b, a; };
     
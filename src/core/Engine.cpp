@@ -4,11 +4,47 @@
 #include "Input.h"
 #include "Config.h"
 #include "Logger.h"
+#include "Trace.h"
 #include <chrono>
-#include <thread>
+#include <algorithm>
 #include <cmath>
+#include <sys/resource.h>
 
-Engine::Engine() {}
+namespace {
+
+// A frame arriving later than this (a stalled loop) moves as if it were on
+// time, so the pointer never leaps after a hiccup.
+constexpr double MAX_FRAME_SECONDS = 0.1;
+
+// heldDirections bits: the arrow-key actions in KeyAction order, then h/j/k/l.
+constexpr uint8_t LEFT = 0x11, RIGHT = 0x22, UP = 0x44, DOWN = 0x88;
+
+uint8_t directionBit(KeyAction action) {
+    return (uint8_t)(1u << ((int)action - (int)KeyAction::MoveLeft));
+}
+
+uint8_t viDirectionBit(char c) {
+    switch (c) {
+        case 'h': return LEFT & 0xf0;
+        case 'l': return RIGHT & 0xf0;
+        case 'k': return UP & 0xf0;
+        case 'j': return DOWN & 0xf0;
+        default:  return 0;
+    }
+}
+
+double processCpuMs() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+} // namespace
+
+Engine::Engine() {
+    activationScratch.reserve(ACTIVATION_SAMPLES);
+}
 
 Engine::~Engine() {}
 
@@ -27,8 +63,31 @@ void Engine::run() {
     }
 }
 
+void Engine::dispatch(const EngineEvent& event) {
+    if (recorder) recorder->recordEvent(event);
+
+    switch (event.type) {
+        case EngineEventType::Activate:    onActivate(); break;
+        case EngineEventType::Deactivate:  onDeactivate(); break;
+        case EngineEventType::Exit:        onExit(); break;
+        case EngineEventType::Char:        onChar(event.c, event.shift); break;
+        case EngineEventType::CharRelease: onKeyRelease(event.c); break;
+        case EngineEventType::Action:      onAction(event.action); break;
+        case EngineEventType::Click:       onClick(event.button, event.count, event.deactivate); break;
+        case EngineEventType::ActionRelease: onActionRelease(event.action); break;
+    }
+}
+
 void Engine::onActivate() {
     if (state.mode != EngineMode::Inactive) return;
+
+    const auto activationStart = std::chrono::steady_clock::now();
+    if (idleCpuMsAtStart >= 0.0) {
+        const double idleSeconds = std::chrono::duration<double>(activationStart - idleSince).count();
+        const double idleCpuMs = processCpuMs() - idleCpuMsAtStart;
+        LOG_INFO("Engine: Idle for ", idleSeconds, " s, process CPU ", idleCpuMs, " ms (",
+                 idleSeconds > 0.0 ? idleCpuMs * 60.0 / idleSeconds : 0.0, " ms/min)");
+    }
     
     state.mode = EngineMode::Level0_FirstChar;
     state.firstChar = '\0';
@@ -36,6 +95,7 @@ void Engine::onActivate() {
     state.gridCols = Config::LEVEL0_GRID_COLS;
     state.recursionDepth = 0;
     state.showPoint = false;
+    state.pointerKept = false;
 
     // Start with full root-screen rect.
     int w, h;
@@ -45,19 +105,28 @@ void Engine::onActivate() {
 
     overlay->show();
 
-    // Overlay geometry can settle asynchronously
+    // Overlay geometry settles asynchronously. Draw as soon as the backend
+    // confirms it; the timeout only applies when no confirmation arrives.
     Rect bestBounds = state.currentRect;
     double bestArea = bestBounds.w * bestBounds.h;
-    for (int i = 0; i < Config::OVERLAY_SETTLE_MAX_RETRIES; ++i) {
-        Rect candidate;
-        if (overlay->getBounds(candidate) && candidate.w > 1.0 && candidate.h > 1.0) {
-            const double area = candidate.w * candidate.h;
-            if (area > bestArea) {
-                bestArea = area;
-                bestBounds = candidate;
-            }
+    const auto settleStart = std::chrono::steady_clock::now();
+    Rect candidate = bestBounds;
+    const bool settled = overlay->waitForSettledBounds(candidate, Config::OVERLAY_SETTLE_TIMEOUT);
+    if (recorder) recorder->recordBounds(w, h, candidate);
+    const auto settleMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - settleStart).count();
+    if (settled) {
+        LOG_DEBUG("Engine: Overlay geometry settled in ", settleMs, " ms");
+    } else {
+        LOG_WARN("Engine: Overlay geometry not confirmed after ", settleMs, " ms, using best known bounds");
+    }
+    if (candidate.w > 1.0 && candidate.h > 1.0) {
+        // Ties go to the overlay: its bounds carry the monitor's origin.
+        const double area = candidate.w * candidate.h;
+        if (area >= bestArea) {
+            bestArea = area;
+            bestBounds = candidate;
         }
-        std::this_thread::sleep_for(Config::OVERLAY_SETTLE_POLL_INTERVAL);
     }
 
     auto nearValue = [](double a, double b, double eps) {
@@ -85,6 +154,8 @@ void Engine::onActivate() {
     }
 
     updateOverlay();
+    reportActivation(std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - activationStart).count());
 
     input->grabKeyboard();
     platform->releaseModifiers();
@@ -95,10 +166,13 @@ void Engine::onDeactivate() {
     if (state.mode == EngineMode::Inactive) return;
     
     LOG_INFO("Engine: Deactivating...");
+    stopMotion();
     state.mode = EngineMode::Inactive;
     overlay->hide();
     input->ungrabKeyboard();
     platform->releaseModifiers();
+    idleSince = std::chrono::steady_clock::now();
+    idleCpuMsAtStart = processCpuMs();
     LOG_INFO("Engine: Deactivated");
 }
 
@@ -120,30 +194,28 @@ void Engine::onChar(char c, bool shiftPressed) {
         c = c + ('a' - 'A');
     }
 
+    if (state.mode == EngineMode::Precision) {
+        if (const uint8_t bit = viDirectionBit(c)) holdDirection(bit, true);
+        return;
+    }
+
     if (state.mode == EngineMode::Level0_FirstChar) {
         if (c >= 'a' && c < 'a' + state.gridRows) {
             state.firstChar = c;
             state.mode = EngineMode::Level0_SecondChar;
+            prerenderRow(c - 'a');
         }
     } 
     else if (state.mode == EngineMode::Level0_SecondChar) {
         if (c >= 'a' && c < 'a' + state.gridCols) {
             int r = state.firstChar - 'a';
             int col = c - 'a';
-            
-            double cellW = state.currentRect.w / state.gridCols;
-            double cellH = state.currentRect.h / state.gridRows;
-            
-            state.history.push_back(state.currentRect);
+            const int index = r * state.gridCols + col;
 
-            state.currentRect.x += col * cellW;
-            state.currentRect.y += r * cellH;
-            state.currentRect.w = cellW;
-            state.currentRect.h = cellH;
-            
-            int cursorX = (int)(state.currentRect.x + state.currentRect.w / 2);
-            int cursorY = (int)(state.currentRect.y + state.currentRect.h / 2);
-            platform->moveCursor(cursorX, cursorY);
+            state.history.push_back(state.currentRect);
+            state.currentRect = state.layout.cell(index);
+            state.pointerKept = false;
+            moveCursorTo(state.layout.centerX(index), state.layout.centerY(index));
             
             // Switch to level 1 recursive mode
             state.gridRows = Config::LEVEL1_GRID_ROWS;
@@ -162,25 +234,14 @@ void Engine::onChar(char c, bool shiftPressed) {
         if (c >= 'a' && c <= 'z') index = c - 'a';
         else if (c >= '0' && c <= '9') index = 26 + (c - '0');
         
-        if (index >= 0 && index < state.gridRows * state.gridCols) {
-            int r = index / state.gridCols;
-            int col = index % state.gridCols;
-            
-            double cellW = state.currentRect.w / state.gridCols;
-            double cellH = state.currentRect.h / state.gridRows;
-            
-            if (cellW < 1.0 || cellH < 1.0) return;
+        if (index >= 0 && index < state.layout.cellCount()) {
+            const Rect cell = state.layout.cell(index);
+            if (cell.w < 1.0 || cell.h < 1.0) return;
 
             state.history.push_back(state.currentRect);
-
-            state.currentRect.x += col * cellW;
-            state.currentRect.y += r * cellH;
-            state.currentRect.w = cellW;
-            state.currentRect.h = cellH;
-            
-            int cursorX = (int)(state.currentRect.x + state.currentRect.w / 2);
-            int cursorY = (int)(state.currentRect.y + state.currentRect.h / 2);
-            platform->moveCursor(cursorX, cursorY);
+            state.currentRect = cell;
+            state.pointerKept = false;
+            moveCursorTo(state.layout.centerX(index), state.layout.centerY(index));
             
             state.recursionDepth++;
             state.lastPressedChar = c; // Remember this key to handle release later
@@ -201,6 +262,11 @@ void Engine::onKeyRelease(char c) {
         c = c + ('a' - 'A');
     }
 
+    if (state.mode == EngineMode::Precision) {
+        if (const uint8_t bit = viDirectionBit(c)) holdDirection(bit, false);
+        return;
+    }
+
     // If the final recursion key is released, we deactivate the engine.
     if (state.mode == EngineMode::Level1_Recursive && 
         state.recursionDepth >= Config::MAX_RECURSION_DEPTH &&
@@ -209,24 +275,129 @@ void Engine::onKeyRelease(char c) {
     }
 }
 
-void Engine::onControlKey(const std::string& key) {
+void Engine::onAction(KeyAction action) {
     if (state.mode == EngineMode::Inactive) return;
 
-    if (key == "space") {
-        onClick(1, 1, true); // Left click
-    } else if (key == "enter") {
-        onClick(3, 1, true); // Right click
-    } else if (key == "backspace") {
-        onUndo();
+    switch (action) {
+        case KeyAction::LeftClick:  onClick(1, 1, true); break;
+        case KeyAction::RightClick: onClick(3, 1, true); break;
+        case KeyAction::Undo:       onUndo(); break;
+        case KeyAction::Deactivate: onDeactivate(); break;
+        case KeyAction::StayClick:  onClick(1, 1, false); break;
+        case KeyAction::Precision:
+            if (state.mode == EngineMode::Level1_Recursive) enterPrecision();
+            else if (state.mode == EngineMode::Precision) leavePrecision(false);
+            break;
+        case KeyAction::MoveLeft:
+        case KeyAction::MoveRight:
+        case KeyAction::MoveUp:
+        case KeyAction::MoveDown:
+            // Autorepeat lands here too: a no-op while held, and it starts
+            // motion for a key that was already down when precision began.
+            if (state.mode == EngineMode::Precision) holdDirection(directionBit(action), true);
+            break;
+        case KeyAction::Unbound:       break;
     }
 }
 
+void Engine::onActionRelease(KeyAction action) {
+    if (state.mode != EngineMode::Precision || !isDirection(action)) return;
+    holdDirection(directionBit(action), false);
+}
+
+// At the last recursion level, releasing the final key deactivates, so
+// precision mode is entered there by pressing its key while that one is held.
+void Engine::enterPrecision() {
+    state.mode = EngineMode::Precision;
+    state.screenRect = state.history.empty() ? state.currentRect : state.history.front();
+    if (!state.pointerKept) {
+        state.pointerX = (int)(state.currentRect.x + state.currentRect.w / 2);
+        state.pointerY = (int)(state.currentRect.y + state.currentRect.h / 2);
+    }
+    state.heldDirections = 0;
+    overlay->hide(); // Nothing covers the pixels being aimed at
+    LOG_INFO("Engine: Precision motion from ", state.pointerX, ", ", state.pointerY);
+}
+
+// Undo snaps back to the cell centre. Toggling off keeps the adjusted
+// pointer for clicks and for the next toggle; a new selection drops it.
+void Engine::leavePrecision(bool snapBack) {
+    stopMotion();
+    state.mode = EngineMode::Level1_Recursive;
+    state.pointerKept = !snapBack;
+    overlay->show();
+    if (snapBack) {
+        moveCursorTo((int)(state.currentRect.x + state.currentRect.w / 2),
+                     (int)(state.currentRect.y + state.currentRect.h / 2));
+    } else {
+        state.showPoint = false; // It would mark the centre, not the pointer
+    }
+    updateOverlay();
+}
+
+void Engine::holdDirection(uint8_t bit, bool held) {
+    const uint8_t before = state.heldDirections;
+    if (held) state.heldDirections |= bit;
+    else state.heldDirections &= (uint8_t)~bit;
+
+    if (!before && state.heldDirections) {
+        // The speed ramp restarts whenever the pointer comes to rest.
+        state.motionStart = state.lastFrame = std::chrono::steady_clock::now();
+        platform->setFrameTicks(true);
+    } else if (before && !state.heldDirections) {
+        platform->setFrameTicks(false);
+    }
+}
+
+void Engine::stopMotion() {
+    if (!state.heldDirections) return;
+    state.heldDirections = 0;
+    platform->setFrameTicks(false);
+}
+
+void Engine::onFrame(std::chrono::steady_clock::time_point now) {
+    if (state.mode != EngineMode::Precision || !state.heldDirections) return;
+
+    // Distance follows elapsed time rather than the tick count, so a late
+    // tick moves further instead of the pointer stuttering under load.
+    const double dt = std::min(std::chrono::duration<double>(now - state.lastFrame).count(), MAX_FRAME_SECONDS);
+    if (dt <= 0.0) return;
+    state.lastFrame = now;
+
+    const uint8_t held = state.heldDirections;
+    const int dx = ((held & RIGHT) ? 1 : 0) - ((held & LEFT) ? 1 : 0);
+    const int dy = ((held & DOWN) ? 1 : 0) - ((held & UP) ? 1 : 0);
+    if (dx == 0 && dy == 0) return;
+
+    const double ramp = std::chrono::duration<double>(Config::PRECISION_RAMP).count();
+    const double heldFor = std::chrono::duration<double>(now - state.motionStart).count();
+    const double progress = ramp > 0.0 ? std::min(heldFor / ramp, 1.0) : 1.0;
+    const double speed = Config::PRECISION_MIN_SPEED +
+        (Config::PRECISION_MAX_SPEED - Config::PRECISION_MIN_SPEED) * std::pow(progress, Config::PRECISION_CURVE);
+    const double step = speed * dt * ((dx != 0 && dy != 0) ? M_SQRT1_2 : 1.0);
+
+    // Sub-pixel remainders carry over, so slow speeds still move evenly.
+    const Rect& screen = state.screenRect;
+    const long oldX = std::lround(state.pointerX);
+    const long oldY = std::lround(state.pointerY);
+    state.pointerX = std::clamp(state.pointerX + dx * step, screen.x, screen.x + screen.w - 1.0);
+    state.pointerY = std::clamp(state.pointerY + dy * step, screen.y, screen.y + screen.h - 1.0);
+    const long x = std::lround(state.pointerX);
+    const long y = std::lround(state.pointerY);
+    if (x != oldX || y != oldY) moveCursorTo((int)x, (int)y, false);
+}
+
 void Engine::onUndo() {
     if (state.mode == EngineMode::Inactive) return;
+    if (state.mode == EngineMode::Precision) {
+        leavePrecision(true);
+        return;
+    }
     
     // Ensure overlay is visible when we back up from a final selection
     overlay->show();
     state.showPoint = false;
+    state.pointerKept = false;
 
     if (state.mode == EngineMode::Level0_SecondChar) {
         state.mode = EngineMode::Level0_FirstChar;
@@ -250,7 +421,7 @@ void Engine::onUndo() {
         
         int cursorX = (int)(state.currentRect.x + state.currentRect.w / 2);
         int cursorY = (int)(state.currentRect.y + state.currentRect.h / 2);
-        platform->moveCursor(cursorX, cursorY);
+        moveCursorTo(cursorX, cursorY);
         
         updateOverlay();
     }
@@ -261,33 +432,95 @@ void Engine::onClick(int button, int count, bool deactivate) {
 
     LOG_INFO("Engine: Click Request - Button: ", button, " Count: ", count);
 
-    int centerX = (int)(state.currentRect.x + state.currentRect.w / 2);
-    int centerY = (int)(state.currentRect.y + state.currentRect.h / 2);
-    platform->moveCursor(centerX, centerY);
+    if (state.mode == EngineMode::Precision || state.pointerKept) {
+        moveCursorTo((int)std::lround(state.pointerX), (int)std::lround(state.pointerY), false);
+    } else {
+        int centerX = (int)(state.currentRect.x + state.currentRect.w / 2);
+        int centerY = (int)(state.currentRect.y + state.currentRect.h / 2);
+        moveCursorTo(centerX, centerY);
+    }
 
+    const auto handoffStart = std::chrono::steady_clock::now();
     if (deactivate) {
         onDeactivate(); // Ungrabs the keyboard and hides overlay
-        // Critical: Give GTK/Wayland a moment to process the keyboard ungrab
-        // before we inject the mouse click, otherwise GTK ignores the click.
-        std::this_thread::sleep_for(Config::POST_UNGRAB_DELAY);
     } else {
         // If we are NOT deactivating (just a click while holding a key), 
         // we briefly hide the overlay to let the OS process the click target
         // correctly if it's sensitive to overlay windows.
         if (overlay) overlay->hide();
-        std::this_thread::sleep_for(Config::POST_UNGRAB_DELAY);
+    }
+
+    // Critical: GTK/Wayland must process the keyboard ungrab and the overlay
+    // unmap before we inject the mouse click, otherwise the click is ignored.
+    // Inject as soon as the backends confirm; POST_UNGRAB_DELAY is only the upper bound.
+    const bool confirmed = awaitClickHandoff(handoffStart + Config::POST_UNGRAB_DELAY, deactivate);
+    const double handoffMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - handoffStart).count();
+    if (confirmed) {
+        LOG_INFO("Engine: Click handoff confirmed in ", handoffMs, " ms");
+    } else {
+        LOG_WARN("Engine: Click handoff not confirmed, injecting after ", handoffMs, " ms");
     }
 
     platform->clickMouse(button, count);
 
-    if (!deactivate && overlay) {
-        overlay->show();
+    // A shown overlay takes input again, so it comes back only after the
+    // last release, not while later presses of a multi-click are queued.
+    if (!deactivate && overlay && state.mode != EngineMode::Precision) {
+        platform->afterClick([this]() {
+            if (state.mode != EngineMode::Inactive && state.mode != EngineMode::Precision) overlay->show();
+        });
     }
 }
 
+bool Engine::awaitClickHandoff(std::chrono::steady_clock::time_point deadline, bool ungrabbed) {
+    auto remaining = [deadline]() {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        return std::max(left, std::chrono::milliseconds(0));
+    };
+
+    bool confirmed = true;
+    if (ungrabbed && input && !input->waitUntilUngrabbed(remaining())) confirmed = false;
+    if (overlay && !overlay->waitUntilHidden(remaining())) confirmed = false;
+    return confirmed;
+}
+
 void Engine::updateOverlay() {
-    overlay->updateGrid(state.gridRows, state.gridCols, 
-                        state.currentRect.x, state.currentRect.y, 
-                        state.currentRect.w, state.currentRect.h,
-                        state.showPoint);
+    state.layout.assign(state.currentRect, state.gridRows, state.gridCols);
+    overlay->updateGrid(state.layout, state.showPoint);
+}
+
+void Engine::reportActivation(double latencyMs) {
+    activationLatenciesMs[activationSamples % ACTIVATION_SAMPLES] = latencyMs;
+    ++activationSamples;
+    const size_t count = std::min(activationSamples, ACTIVATION_SAMPLES);
+
+    // Partial selection on a reused copy: no allocation and no full sort.
+    activationScratch.assign(activationLatenciesMs.begin(), activationLatenciesMs.begin() + count);
+    const auto first = activationScratch.begin();
+    const size_t mid = count / 2;
+    const size_t p95Index = (size_t)((count - 1) * 0.95);
+    std::nth_element(first, first + mid, activationScratch.end());
+    if (p95Index > mid) std::nth_element(first + mid + 1, first + p95Index, activationScratch.end());
+    else if (p95Index < mid) std::nth_element(first, first + p95Index, first + mid);
+    LOG_INFO("Engine: Activation drawn in ", latencyMs, " ms (median ", activationScratch[mid], ", p95 ",
+             activationScratch[p95Index], " over ", count, ", standby ", Config::OVERLAY_STANDBY ? "on" : "off", ")");
+}
+
+void Engine::prerenderRow(int row) {
+    if (!Config::OVERLAY_PRERENDER) return;
+
+    // The second key picks one of these cells and shows its Level1 grid.
+    std::vector<GridLayout> candidates;
+    candidates.reserve(state.gridCols);
+    for (int col = 0; col < state.gridCols; ++col) {
+        candidates.emplace_back(state.layout.cell(row, col), Config::LEVEL1_GRID_ROWS, Config::LEVEL1_GRID_COLS);
+    }
+    overlay->prerender(candidates);
+}
+
+void Engine::moveCursorTo(int x, int y, bool animate) {
+    if (animate) platform->moveCursor(x, y);
+    else platform->warpCursor(x, y);
+    if (recorder) recorder->recordCursor(x, y);
 }
@@ -1,20 +1,26 @@
 #ifndef ENGINE_H
 #define ENGINE_H
 
+#include <array>
 #include <vector>
 #include <string>
+#include <chrono>
 #include "Types.h"
+#include "EngineEvent.h"
+#include "GridLayout.h"
 
 // Forward declarations
 class Platform;
 class Overlay;
 class Input;
+class TraceWriter;
 
 enum class EngineMode {
     Inactive,
     Level0_FirstChar,
     Level0_SecondChar,
-    Level1_Recursive
+    Level1_Recursive,
+    Precision // Overlay hidden; held direction keys steer the pointer
 };
 
 struct EngineState {
@@ -27,6 +33,16 @@ struct EngineState {
     char lastPressedChar = '\0';
     bool showPoint = false;
     int recursionDepth = 0;
+    GridLayout layout; // Cells of currentRect at gridRows x gridCols, rebuilt by updateOverlay()
+
+    // Precision mode
+    Rect screenRect;                 // The pointer stays inside the activated screen
+    double pointerX = 0.0;           // Sub-pixel pointer position
+    double pointerY = 0.0;
+    bool pointerKept = false;        // Left by toggling off; clicks land at the pointer
+    uint8_t heldDirections = 0;      // Bit per KeyAction direction, then per h/j/k/l
+    std::chrono::steady_clock::time_point motionStart;
+    std::chrono::steady_clock::time_point lastFrame;
 };
 
 class Engine {
@@ -37,28 +53,58 @@ public:
     void initialize();
     void run();
 
+    // Entry point for events queued by input threads; runs on the reactor thread
+    void dispatch(const EngineEvent& event);
+
     // Callbacks from Platform/Input
     void onActivate(); 
     void onDeactivate(); 
     void onChar(char c, bool shiftPressed);
     void onKeyRelease(char c);
-    void onControlKey(const std::string& key);
+    void onAction(KeyAction action);
     void onUndo();
     void onClick(int button, int count, bool deactivate = true);
     void onExit(); 
+    void onActionRelease(KeyAction action);
+
+    // Display refresh tick from the platform while precision motion is running
+    void onFrame(std::chrono::steady_clock::time_point now);
+
+    // Rebuilds the grid layout and sends it to the overlay
+    void updateOverlay();
     
     // Dependencies
     void setPlatform(Platform* p) { platform = p; }
     void setOverlay(Overlay* o) { overlay = o; }
     void setInput(Input* i) { input = i; }
+    // Optional: every dispatched event and resulting cursor move is appended to the trace
+    void setRecorder(TraceWriter* r) { recorder = r; }
 
 private:
-    void updateOverlay();
     void resetSelection();
+    void moveCursorTo(int x, int y, bool animate = true);
+    void enterPrecision();
+    void leavePrecision(bool snapBack);
+    void holdDirection(uint8_t bit, bool held);
+    void stopMotion();
+    void prerenderRow(int row);
+    void reportActivation(double latencyMs);
+    bool awaitClickHandoff(std::chrono::steady_clock::time_point deadline, bool ungrabbed);
 
     Platform* platform = nullptr;
     Overlay* overlay = nullptr;
     Input* input = nullptr;
+    TraceWriter* recorder = nullptr;
     EngineState state;
+
+    // Activation latency (show() until the first grid is sent) and process CPU
+    // while idle, logged per activation so overlay modes can be compared.
+    // The latest ACTIVATION_SAMPLES latencies are kept in a ring.
+    static constexpr size_t ACTIVATION_SAMPLES = 256;
+    std::array<double, ACTIVATION_SAMPLES> activationLatenciesMs{};
+    size_t activationSamples = 0; // Total recorded; the next slot is this % ACTIVATION_SAMPLES
+    std::vector<double> activationScratch;
+    std::chrono::steady_clock::time_point idleSince;
+    double idleCpuMsAtStart = -1.0;
 };
 #endif // ENGINE_H
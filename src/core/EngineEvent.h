@@ -0,0 +1,48 @@
+#ifndef ENGINEEVENT_H
+#define ENGINEEVENT_H
+
+#include <cstdint>
+
+// Decoded input event handed from an input thread to the Engine's thread.
+enum class EngineEventType : uint8_t {
+    Activate,
+    Deactivate,
+    Exit,
+    Char,
+    CharRelease,
+    Action,
+    Click,
+    ActionRelease // Direction keys only, so the Engine knows when motion stops
+};
+
+// What a bound key does while the keyboard is grabbed (see Keymap). The
+// first three keep the values recorded traces store for them.
+enum class KeyAction : uint8_t {
+    LeftClick,  // Space by default
+    RightClick, // Enter
+    Undo,       // Backspace: back up one selection
+    Deactivate, // Escape: hide the grid without clicking
+    StayClick,  // Delete: left click and keep the grid up
+    Precision,  // Tab: steer the pointer with direction keys from Level1
+    MoveLeft,   // Arrow keys, held while in precision mode
+    MoveRight,
+    MoveUp,
+    MoveDown,
+    Unbound
+};
+
+inline bool isDirection(KeyAction action) {
+    return action >= KeyAction::MoveLeft && action <= KeyAction::MoveDown;
+}
+
+struct EngineEvent {
+    EngineEventType type = EngineEventType::Char;
+    char c = '\0';            // Char, CharRelease
+    bool shift = false;       // Char
+    KeyAction action = KeyAction::Unbound; // Action, ActionRelease
+    uint8_t button = 1;       // Click
+    uint8_t count = 1;        // Click
+    bool deactivate = true;   // Click
+};
+
+#endif // ENGINEEVENT_H
@@ -0,0 +1,80 @@
+#include "GridLayout.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+void buildAxis(double origin, double extent, int count,
+               std::vector<double>& edges, std::vector<int>& centers, std::vector<double>& anchors) {
+    edges.resize(count + 1);
+    centers.resize(count);
+    anchors.resize(count);
+
+    for (int i = 0; i <= count; ++i) {
+        edges[i] = std::round(origin + (extent * i) / count);
+    }
+    for (int i = 0; i < count; ++i) {
+        centers[i] = (int)std::floor((edges[i] + edges[i + 1]) / 2.0);
+        anchors[i] = (edges[i] + edges[i + 1]) / 2.0;
+    }
+}
+
+} // namespace
+
+GridLayout::GridLayout(const Rect& rect, int rows, int cols) {
+    assign(rect, rows, cols);
+}
+
+void GridLayout::assign(const Rect& rect, int rows, int cols) {
+    rowCount = std::max(rows, 0);
+    colCount = std::max(cols, 0);
+    if (empty()) {
+        outer = {0.0, 0.0, 0.0, 0.0};
+        return;
+    }
+
+    buildAxis(rect.x, rect.w, colCount, colEdges, centersX, anchorsX);
+    buildAxis(rect.y, rect.h, rowCount, rowEdges, centersY, anchorsY);
+    outer = {colEdges.front(), rowEdges.front(),
+             colEdges.back() - colEdges.front(), rowEdges.back() - rowEdges.front()};
+}
+
+Rect GridLayout::cell(int r, int c) const {
+    return {colEdges[c], rowEdges[r], colEdges[c + 1] - colEdges[c], rowEdges[r + 1] - rowEdges[r]};
+}
+
+GridLayout GridLayout::translated(double dx, double dy) const {
+    GridLayout out = *this;
+    dx = std::round(dx);
+    dy = std::round(dy);
+    for (double& e : out.colEdges) e += dx;
+    for (double& e : out.rowEdges) e += dy;
+    for (double& a : out.anchorsX) a += dx;
+    for (double& a : out.anchorsY) a += dy;
+    for (int& c : out.centersX) c += (int)dx;
+    for (int& c : out.centersY) c += (int)dy;
+    out.outer.x += dx;
+    out.outer.y += dy;
+    return out;
+}
+
+std::string GridLayout::labelForIndex(int index, int cols) {
+    if (cols == 6) {
+        if (index >= 0 && index < 26) {
+            char c = 'A' + index;
+            return std::string(1, c);
+        } else if (index >= 26 && index < 36) {
+            char c = '0' + (index - 26);
+            return std::string(1, c);
+        }
+    } else { // Assume 11x11
+        int r = index / cols;
+        int c = index % cols;
+        if (r < 11 && c < 11) {
+            char rowChar = 'A' + r;
+            char colChar = 'A' + c;
+            return std::string{rowChar, colChar};
+        }
+    }
+    return "";
+}
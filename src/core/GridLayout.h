@@ -0,0 +1,63 @@
+#ifndef GRIDLAYOUT_H
+#define GRIDLAYOUT_H
+
+#include "Types.h"
+#include <string>
+#include <vector>
+
+// Cell geometry for one grid level, built once per keystroke from the current
+// rect and rows/cols. Edges are snapped to whole pixels, so neighbouring
+// cells share an edge exactly. The Engine takes cursor targets from it and
+// the overlays draw from it, so both use the same pixels.
+class GridLayout {
+public:
+    GridLayout() = default;
+    GridLayout(const Rect& rect, int rows, int cols);
+
+    // Rebuild in place, reusing the table storage
+    void assign(const Rect& rect, int rows, int cols);
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    int cellCount() const { return rowCount * colCount; }
+    bool empty() const { return rowCount <= 0 || colCount <= 0; }
+
+    // Snapped outer rect (the first and last edges)
+    const Rect& bounds() const { return outer; }
+
+    // Edge c of cols + 1 (row edge r of rows + 1)
+    double colEdge(int c) const { return colEdges[c]; }
+    double rowEdge(int r) const { return rowEdges[r]; }
+
+    Rect cell(int r, int c) const;
+    Rect cell(int index) const { return cell(index / colCount, index % colCount); }
+
+    // Pixel the cursor is moved to when the cell is selected
+    int centerX(int index) const { return centersX[index % colCount]; }
+    int centerY(int index) const { return centersY[index / colCount]; }
+
+    // Point the cell's label is centred on
+    double labelAnchorX(int index) const { return anchorsX[index % colCount]; }
+    double labelAnchorY(int index) const { return anchorsY[index / colCount]; }
+    std::string label(int index) const { return labelForIndex(index, colCount); }
+
+    // Same layout shifted by whole pixels, e.g. from root to window coordinates
+    GridLayout translated(double dx, double dy) const;
+
+    static std::string labelForIndex(int index, int cols);
+
+private:
+    int rowCount = 0;
+    int colCount = 0;
+    Rect outer{0.0, 0.0, 0.0, 0.0};
+
+    // Flat per-axis tables; a cell is addressed by (index / cols, index % cols)
+    std::vector<double> colEdges;
+    std::vector<double> rowEdges;
+    std::vector<int> centersX;
+    std::vector<int> centersY;
+    std::vector<double> anchorsX;
+    std::vector<double> anchorsY;
+};
+
+#endif // GRIDLAYOUT_H
@@ -1,6 +1,9 @@
 #ifndef INPUT_H
 #define INPUT_H
 
+#include <chrono>
+#include <functional>
+
 // Interface for input manager
 class Input {
 public:
@@ -8,10 +11,20 @@ public:
     virtual bool initialize(int screenW = 0, int screenH = 0) = 0;
     virtual void grabKeyboard() = 0; // Modal
     virtual void ungrabKeyboard() = 0;
+
+    // Blocks until the backend confirms ungrabKeyboard() took effect, or
+    // until the timeout expires. Returns false on timeout.
+    virtual bool waitUntilUngrabbed(std::chrono::milliseconds timeout) {
+        (void)timeout;
+        return true;
+    }
     
     // Optional virtual mouse support (for Wayland/Evdev)
     virtual void moveMouse(int x, int y, int screenW, int screenH) {}
     virtual void clickMouse(int button, int count) {}
+    // Runs `step` once the steps queued by clickMouse() have been injected,
+    // on whichever thread injects them
+    virtual void afterClick(std::function<void()> step) { step(); }
     // ... other methods to send keycodes to engine
 };
 
@@ -0,0 +1,176 @@
+#include "Keymap.h"
+#include "Config.h"
+#include "Logger.h"
+#include <linux/input-event-codes.h>
+#include <X11/keysym.h>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// Labels on the three letter rows, key by key from the physical positions
+// of Q..], A..' and Z../ on a US keyboard. Only the letters are used.
+struct Layout {
+    const char* name;
+    const char* top;
+    const char* home;
+    const char* bottom;
+};
+
+const Layout LAYOUTS[] = {
+    {"qwerty",  "qwertyuiop[]", "asdfghjkl;'", "zxcvbnm,./"},
+    {"qwertz",  "qwertzuiop..", "asdfghjkl..", "yxcvbnm,.-"},
+    {"azerty",  "azertyuiop^$", "qsdfghjklm.", "wxcvbn,;:!"},
+    {"dvorak",  "',.pyfgcrl/=", "aoeuidhtns-", ";qjkxbmwvz"},
+    {"colemak", "qwfpgjluy;[]", "arstdhneio'", "zxcvbkm,./"},
+};
+
+struct NamedKey {
+    const char* name;
+    int code;
+    unsigned long keysym;
+};
+
+const NamedKey NAMED_KEYS[] = {
+    {"escape", KEY_ESC, XK_Escape},
+    {"space", KEY_SPACE, XK_space},
+    {"enter", KEY_ENTER, XK_Return},
+    {"backspace", KEY_BACKSPACE, XK_BackSpace},
+    {"tab", KEY_TAB, XK_Tab},
+    {"delete", KEY_DELETE, XK_Delete},
+    {"left", KEY_LEFT, XK_Left},
+    {"right", KEY_RIGHT, XK_Right},
+    {"up", KEY_UP, XK_Up},
+    {"down", KEY_DOWN, XK_Down},
+};
+
+// In KeyAction order
+const char* const DEFAULT_KEYS[] = {"space", "enter", "backspace", "escape", "delete",
+                                    "tab", "left", "right", "up", "down"};
+const char* const ACTION_NAMES[] = {"left click", "right click", "undo", "deactivate", "stay click",
+                                    "precision", "move left", "move right", "move up", "move down"};
+
+std::string lowered(const std::string& text) {
+    std::string out = text;
+    std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return out;
+}
+
+Keymap& instance() {
+    static Keymap map;
+    return map;
+}
+
+} // namespace
+
+Keymap::Keymap() {
+    for (int i = 0; i < ACTION_COUNT; ++i) actionKeys[i] = DEFAULT_KEYS[i];
+    setLayout("qwerty");
+}
+
+bool Keymap::setLayout(const std::string& layout) {
+    const std::string name = lowered(layout);
+    const Layout* found = nullptr;
+    for (const Layout& candidate : LAYOUTS) {
+        if (name == candidate.name) found = &candidate;
+    }
+    if (!found) return false;
+
+    std::fill(std::begin(layoutChars), std::end(layoutChars), '\0');
+    // The number row is the same everywhere that matters here.
+    for (int digit = 1; digit <= 9; ++digit) layoutChars[KEY_1 + digit - 1] = (char)('0' + digit);
+    layoutChars[KEY_0] = '0';
+
+    auto place = [this](int firstCode, const char* labels) {
+        for (int i = 0; labels[i]; ++i) {
+            if (std::isalpha((unsigned char)labels[i])) layoutChars[firstCode + i] = labels[i];
+        }
+    };
+    place(KEY_Q, found->top);
+    place(KEY_A, found->home);
+    place(KEY_Z, found->bottom);
+
+    rebuild();
+    return true;
+}
+
+bool Keymap::bind(KeyAction action, const std::string& keyName) {
+    if (action == KeyAction::Unbound) return false;
+
+    const std::string name = lowered(keyName);
+    bool known = name.size() == 1 && std::isalnum((unsigned char)name[0]);
+    for (const NamedKey& key : NAMED_KEYS) {
+        if (name == key.name) known = true;
+    }
+    if (!known) return false;
+
+    actionKeys[(int)action] = name;
+    rebuild();
+    return true;
+}
+
+void Keymap::rebuild() {
+    std::fill(std::begin(evdevTable), std::end(evdevTable), KeyBinding{});
+    std::fill(std::begin(keysymTable), std::end(keysymTable), KeyBinding{});
+
+    for (int code = 0; code < EVDEV_CODES; ++code) evdevTable[code].c = layoutChars[code];
+    for (char c = 'a'; c <= 'z'; ++c) {
+        keysymTable[keysymSlot((unsigned long)c)].c = c;
+        keysymTable[keysymSlot((unsigned long)(c - 'a' + 'A'))].c = c;
+    }
+    for (char c = '0'; c <= '9'; ++c) keysymTable[keysymSlot((unsigned long)c)].c = c;
+
+    // Later actions win when two share a key; load() warns about that. A key
+    // bound to an action no longer types its label, so it never also picks a cell.
+    for (int i = 0; i < ACTION_COUNT; ++i) {
+        const std::string& name = actionKeys[i];
+        const KeyAction action = (KeyAction)i;
+        if (name.size() == 1) {
+            const char c = name[0];
+            for (int code = 1; code < EVDEV_CODES; ++code) {
+                if (layoutChars[code] == c) evdevTable[code] = {action, '\0'};
+            }
+            keysymTable[keysymSlot((unsigned long)c)] = {action, '\0'};
+            if (std::isalpha((unsigned char)c)) {
+                keysymTable[keysymSlot((unsigned long)std::toupper((unsigned char)c))] = {action, '\0'};
+            }
+            continue;
+        }
+        for (const NamedKey& key : NAMED_KEYS) {
+            if (name != key.name) continue;
+            evdevTable[key.code].action = action;
+            keysymTable[keysymSlot(key.keysym)].action = action;
+        }
+    }
+}
+
+const Keymap& Keymap::current() {
+    return instance();
+}
+
+void Keymap::load() {
+    Keymap map;
+    if (!map.setLayout(Config::KEYBOARD_LAYOUT)) {
+        LOG_WARN("Keymap: Unknown keyboard_layout '", Config::KEYBOARD_LAYOUT, "', using qwerty");
+    }
+
+    // In KeyAction order
+    const std::string* keys[] = {&Config::BIND_LEFT_CLICK, &Config::BIND_RIGHT_CLICK, &Config::BIND_UNDO,
+                                 &Config::BIND_DEACTIVATE, &Config::BIND_STAY_CLICK, &Config::BIND_PRECISION,
+                                 &Config::BIND_MOVE_LEFT, &Config::BIND_MOVE_RIGHT, &Config::BIND_MOVE_UP,
+                                 &Config::BIND_MOVE_DOWN};
+    for (int i = 0; i < ACTION_COUNT; ++i) {
+        if (!map.bind((KeyAction)i, *keys[i])) {
+            LOG_WARN("Keymap: Unknown key '", *keys[i], "' for ", ACTION_NAMES[i], ", keeping ", map.actionKeys[i]);
+        }
+    }
+    for (int i = 0; i < ACTION_COUNT; ++i) {
+        for (int j = i + 1; j < ACTION_COUNT; ++j) {
+            if (map.actionKeys[i] == map.actionKeys[j]) {
+                LOG_WARN("Keymap: ", ACTION_NAMES[i], " and ", ACTION_NAMES[j], " share key '",
+                         map.actionKeys[i], "'; it does ", ACTION_NAMES[j]);
+            }
+        }
+    }
+    instance() = map;
+}
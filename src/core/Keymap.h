@@ -0,0 +1,64 @@
+#ifndef KEYMAP_H
+#define KEYMAP_H
+
+#include "EngineEvent.h"
+#include <string>
+
+// What one key does while the keyboard is grabbed: an action or a grid
+// label, never both. A letter or digit bound to an action stops typing it.
+struct KeyBinding {
+    KeyAction action = KeyAction::Unbound;
+    char c = '\0'; // Grid label, lower case; '\0' when the key types none
+};
+
+// Flat tables from evdev key codes and X11 keysyms to bindings, compiled
+// from Config at startup so both input backends decode a key with one
+// indexed load. X11 already applies the user's layout when it produces a
+// keysym; evdev reports key positions, so its table follows KEYBOARD_LAYOUT.
+class Keymap {
+public:
+    static constexpr int EVDEV_CODES = 0x300;  // KEY_CNT
+    static constexpr int KEYSYM_SLOTS = 0x200; // Latin-1, then the 0xff00 function keys
+
+    // QWERTY with the default action keys
+    Keymap();
+
+    // Relabels the evdev table for "qwerty", "qwertz", "azerty", "dvorak" or
+    // "colemak" and re-resolves the action keys. False for an unknown layout.
+    bool setLayout(const std::string& layout);
+
+    // Moves `action` to the key called `keyName`: a letter, a digit or one of
+    // escape, space, enter, backspace, tab, delete, left, right, up, down.
+    // Letters are looked up in the current layout. False (binding unchanged)
+    // for an unknown name.
+    bool bind(KeyAction action, const std::string& keyName);
+
+    const KeyBinding& evdev(int code) const {
+        return (unsigned)code < (unsigned)EVDEV_CODES ? evdevTable[code] : evdevTable[0];
+    }
+    const KeyBinding& keysym(unsigned long sym) const { return keysymTable[keysymSlot(sym)]; }
+
+    // Map built from Config by load(), shared by the input backends.
+    static const Keymap& current();
+    // Rebuilds current() from Config; call after Config::loadConfig().
+    static void load();
+
+private:
+    static constexpr int ACTION_COUNT = (int)KeyAction::Unbound;
+
+    // Slot 0 (NoSymbol) stays unbound and absorbs keysyms outside both ranges.
+    static int keysymSlot(unsigned long sym) {
+        if (sym < 0x100) return (int)sym;
+        if ((sym & ~0xfful) == 0xff00) return 0x100 | (int)(sym & 0xff);
+        return 0;
+    }
+
+    void rebuild();
+
+    char layoutChars[EVDEV_CODES] = {}; // Label printed on each key position
+    std::string actionKeys[ACTION_COUNT];
+    KeyBinding evdevTable[EVDEV_CODES];
+    KeyBinding keysymTable[KEYSYM_SLOTS];
+};
+
+#endif // KEYMAP_H
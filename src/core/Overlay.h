@@ -2,6 +2,9 @@
 #define OVERLAY_H
 
 #include "Types.h"
+#include "GridLayout.h"
+#include <chrono>
+#include <vector>
 
 // Interface for overlay renderer
 class Overlay {
@@ -9,8 +12,30 @@ public:
     virtual ~Overlay() {}
     virtual void show() = 0;
     virtual void hide() = 0;
-    virtual void updateGrid(int rows, int cols, double x, double y, double w, double h, bool showPoint = false) = 0;
+    // `layout` is in root coordinates; showPoint draws only the target point at its centre
+    virtual void updateGrid(const GridLayout& layout, bool showPoint = false) = 0;
     virtual bool getBounds(Rect& out) = 0;
+
+    // Hint that the next updateGrid() is likely one of `candidates`, so the
+    // backend may render them ahead of time. Ignored by default.
+    virtual void prerender(const std::vector<GridLayout>& candidates) {
+        (void)candidates;
+    }
+
+    // Blocks until the backend reports that the geometry of the surface
+    // mapped by show() has settled, or until the timeout expires.
+    // Returns false on timeout; `out` then holds the best known bounds.
+    virtual bool waitForSettledBounds(Rect& out, std::chrono::milliseconds timeout) {
+        (void)timeout;
+        return getBounds(out);
+    }
+
+    // Blocks until the backend confirms the surface hidden by hide() is
+    // unmapped, or until the timeout expires. Returns false on timeout.
+    virtual bool waitUntilHidden(std::chrono::milliseconds timeout) {
+        (void)timeout;
+        return true;
+    }
     // ... other visual updates
 };
 
@@ -1,6 +1,8 @@
 #ifndef PLATFORM_H
 #define PLATFORM_H
 
+#include <functional>
+
 // Interface for platform-specific implementations
 class Platform {
 public:
@@ -11,7 +13,14 @@ public:
     virtual void releaseModifiers() = 0;
     virtual void getScreenSize(int& w, int& h) = 0;
     virtual void moveCursor(int x, int y) = 0;
+    // Jumps even where moveCursor() animates; for moves made every frame
+    virtual void warpCursor(int x, int y) { moveCursor(x, y); }
+    // While enabled, calls Engine::onFrame() once per display refresh
+    virtual void setFrameTicks(bool enabled) {}
     virtual void clickMouse(int button, int count) = 0; // button: 1=Left, 2=Middle, 3=Right; count: 1=Single, 2=Double
+    // Runs `step` on the Engine's thread once every button step queued by
+    // clickMouse() has been injected
+    virtual void afterClick(std::function<void()> step) { step(); }
 };
 
 #endif // PLATFORM_H
@@ -0,0 +1,41 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free single-producer/single-consumer ring.
+// push() may only be called from one thread and pop() from one other thread.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool push(const T& item) {
+        const size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - headIndex.load(std::memory_order_acquire) == Capacity) return false; // Full
+        slots[tail & (Capacity - 1)] = item;
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        const size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire)) return false; // Empty
+        out = slots[head & (Capacity - 1)];
+        headIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return headIndex.load(std::memory_order_acquire) == tailIndex.load(std::memory_order_acquire);
+    }
+
+private:
+    // Producer and consumer indices on separate cache lines to avoid false sharing.
+    alignas(64) std::atomic<size_t> headIndex{0};
+    alignas(64) std::atomic<size_t> tailIndex{0};
+    alignas(64) T slots[Capacity];
+};
+
+#endif // SPSCQUEUE_H
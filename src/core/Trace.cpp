@@ -0,0 +1,250 @@
+#include "Trace.h"
+#include "Config.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const char TRACE_MAGIC[4] = {'K', 'N', 'T', 'R'};
+const uint8_t TRACE_VERSION = 2;     // Version 1 traces have no bounds records
+const uint8_t CURSOR_RECORD = 0x80; // Input records use the EngineEventType value
+const uint8_t BOUNDS_RECORD = 0x81;
+
+uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+} // namespace
+
+TraceHeader TraceHeader::fromConfig(int screenW, int screenH) {
+    TraceHeader header;
+    header.screenW = (uint32_t)screenW;
+    header.screenH = (uint32_t)screenH;
+    header.level0Rows = (uint32_t)Config::LEVEL0_GRID_ROWS;
+    header.level0Cols = (uint32_t)Config::LEVEL0_GRID_COLS;
+    header.level1Rows = (uint32_t)Config::LEVEL1_GRID_ROWS;
+    header.level1Cols = (uint32_t)Config::LEVEL1_GRID_COLS;
+    header.maxRecursionDepth = (uint32_t)Config::MAX_RECURSION_DEPTH;
+    return header;
+}
+
+void TraceHeader::applyToConfig() const {
+    Config::LEVEL0_GRID_ROWS = (int)level0Rows;
+    Config::LEVEL0_GRID_COLS = (int)level0Cols;
+    Config::LEVEL1_GRID_ROWS = (int)level1Rows;
+    Config::LEVEL1_GRID_COLS = (int)level1Cols;
+    Config::MAX_RECURSION_DEPTH = (int)maxRecursionDepth;
+}
+
+bool TraceWriter::open(const std::string& path, const TraceHeader& header) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        LOG_ERROR("TraceWriter: Cannot open ", path);
+        return false;
+    }
+
+    out.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    out.put((char)TRACE_VERSION);
+    writeVarint(header.screenW);
+    writeVarint(header.screenH);
+    writeVarint(header.level0Rows);
+    writeVarint(header.level0Cols);
+    writeVarint(header.level1Rows);
+    writeVarint(header.level1Cols);
+    writeVarint(header.maxRecursionDepth);
+
+    start = std::chrono::steady_clock::now();
+    lastNs = 0;
+    LOG_INFO("TraceWriter: Recording session to ", path);
+    return true;
+}
+
+void TraceWriter::close() {
+    if (out.is_open()) out.close();
+}
+
+void TraceWriter::recordEvent(const EngineEvent& event) {
+    if (!out.is_open()) return;
+
+    writeTimestamp();
+    out.put((char)event.type);
+    switch (event.type) {
+        case EngineEventType::Char:
+            out.put(event.c);
+            out.put((char)(event.shift ? 1 : 0));
+            break;
+        case EngineEventType::CharRelease:
+            out.put(event.c);
+            break;
+        case EngineEventType::Action:
+        case EngineEventType::ActionRelease:
+            out.put((char)event.action);
+            break;
+        case EngineEventType::Click:
+            out.put((char)event.button);
+            out.put((char)event.count);
+            out.put((char)(event.deactivate ? 1 : 0));
+            break;
+        case EngineEventType::Activate:
+        case EngineEventType::Deactivate:
+        case EngineEventType::Exit:
+            break;
+    }
+}
+
+void TraceWriter::recordCursor(int x, int y) {
+    if (!out.is_open()) return;
+
+    writeTimestamp();
+    out.put((char)CURSOR_RECORD);
+    writeVarint(zigzag(x));
+    writeVarint(zigzag(y));
+}
+
+void TraceWriter::recordBounds(int screenW, int screenH, const Rect& overlayBounds) {
+    if (!out.is_open()) return;
+
+    writeTimestamp();
+    out.put((char)BOUNDS_RECORD);
+    writeVarint((uint64_t)screenW);
+    writeVarint((uint64_t)screenH);
+    writeVarint(zigzag(std::llround(overlayBounds.x)));
+    writeVarint(zigzag(std::llround(overlayBounds.y)));
+    writeVarint(zigzag(std::llround(overlayBounds.w)));
+    writeVarint(zigzag(std::llround(overlayBounds.h)));
+}
+
+void TraceWriter::writeTimestamp() {
+    const uint64_t nowNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    writeVarint(nowNs - lastNs);
+    lastNs = nowNs;
+}
+
+void TraceWriter::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        out.put((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.put((char)value);
+}
+
+bool TraceReader::open(const std::string& path) {
+    in.open(path, std::ios::binary);
+    if (!in.is_open()) {
+        LOG_ERROR("TraceReader: Cannot open ", path);
+        return false;
+    }
+
+    char magic[sizeof(TRACE_MAGIC)];
+    uint8_t version = 0;
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), TRACE_MAGIC) ||
+        !readByte(version) || version == 0 || version > TRACE_VERSION) {
+        LOG_ERROR("TraceReader: ", path, " is not a KeyNav trace (or has an unsupported version)");
+        return false;
+    }
+
+    uint64_t fields[7];
+    for (uint64_t& field : fields) {
+        if (!readVarint(field)) return false;
+    }
+    traceHeader.screenW = (uint32_t)fields[0];
+    traceHeader.screenH = (uint32_t)fields[1];
+    traceHeader.level0Rows = (uint32_t)fields[2];
+    traceHeader.level0Cols = (uint32_t)fields[3];
+    traceHeader.level1Rows = (uint32_t)fields[4];
+    traceHeader.level1Cols = (uint32_t)fields[5];
+    traceHeader.maxRecursionDepth = (uint32_t)fields[6];
+    lastNs = 0;
+    return true;
+}
+
+bool TraceReader::next(TraceRecord& record) {
+    uint64_t delta = 0;
+    uint8_t type = 0;
+    if (!readVarint(delta) || !readByte(type)) return false;
+
+    lastNs += delta;
+    record = TraceRecord();
+    record.timeNs = lastNs;
+
+    if (type == CURSOR_RECORD) {
+        uint64_t x = 0;
+        uint64_t y = 0;
+        if (!readVarint(x) || !readVarint(y)) return false;
+        record.isCursor = true;
+        record.cursorX = (int)unzigzag(x);
+        record.cursorY = (int)unzigzag(y);
+        return true;
+    }
+
+    if (type == BOUNDS_RECORD) {
+        uint64_t fields[6];
+        for (uint64_t& field : fields) {
+            if (!readVarint(field)) return false;
+        }
+        record.isBounds = true;
+        record.screenW = (int)fields[0];
+        record.screenH = (int)fields[1];
+        record.overlayBounds = {(double)unzigzag(fields[2]), (double)unzigzag(fields[3]),
+                                (double)unzigzag(fields[4]), (double)unzigzag(fields[5])};
+        return true;
+    }
+
+    uint8_t a = 0;
+    uint8_t b = 0;
+    uint8_t c = 0;
+    record.event.type = (EngineEventType)type;
+    switch (record.event.type) {
+        case EngineEventType::Char:
+            if (!readByte(a) || !readByte(b)) return false;
+            record.event.c = (char)a;
+            record.event.shift = b != 0;
+            return true;
+        case EngineEventType::CharRelease:
+            if (!readByte(a)) return false;
+            record.event.c = (char)a;
+            return true;
+        case EngineEventType::Action:
+        case EngineEventType::ActionRelease:
+            if (!readByte(a)) return false;
+            record.event.action = (KeyAction)a;
+            return true;
+        case EngineEventType::Click:
+            if (!readByte(a) || !readByte(b) || !readByte(c)) return false;
+            record.event.button = a;
+            record.event.count = b;
+            record.event.deactivate = c != 0;
+            return true;
+        case EngineEventType::Activate:
+        case EngineEventType::Deactivate:
+        case EngineEventType::Exit:
+            return true;
+    }
+
+    LOG_ERROR("TraceReader: Unknown record type ", (int)type);
+    return false;
+}
+
+bool TraceReader::readByte(uint8_t& value) {
+    char byte = 0;
+    if (!in.get(byte)) return false;
+    value = (uint8_t)byte;
+    return true;
+}
+
+bool TraceReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = 0;
+        if (!readByte(byte)) return false;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,84 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "EngineEvent.h"
+#include "Types.h"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Compact binary session trace. It holds the events the backends hand to
+// Engine::dispatch, and the cursor positions the Engine produced from them,
+// so a replay can measure throughput and detect behavioural divergence.
+//
+// Layout: "KNTR", version byte, varint header fields, then records of
+// varint delta-ns timestamp, type byte and a small per-type payload.
+// Each activation is followed by a bounds record: the root size and the
+// overlay bounds it settled on, which place the grid on a multi-monitor
+// desktop and so decide every cursor position until the next activation.
+
+struct TraceHeader {
+    uint32_t screenW = 0;
+    uint32_t screenH = 0;
+    uint32_t level0Rows = 0;
+    uint32_t level0Cols = 0;
+    uint32_t level1Rows = 0;
+    uint32_t level1Cols = 0;
+    uint32_t maxRecursionDepth = 0;
+
+    // Snapshot of the current Config grid settings.
+    static TraceHeader fromConfig(int screenW, int screenH);
+    // Apply the recorded grid settings to Config before replaying.
+    void applyToConfig() const;
+};
+
+struct TraceRecord {
+    uint64_t timeNs = 0;   // Since the start of the recording
+    bool isCursor = false; // Cursor move produced by the Engine
+    bool isBounds = false; // Geometry seen by the activation before it
+    EngineEvent event;     // Input event when neither flag is set
+    int cursorX = 0;
+    int cursorY = 0;
+    int screenW = 0;
+    int screenH = 0;
+    Rect overlayBounds = {0.0, 0.0, 0.0, 0.0};
+};
+
+class TraceWriter {
+public:
+    bool open(const std::string& path, const TraceHeader& header);
+    bool isOpen() const { return out.is_open(); }
+    void close();
+
+    void recordEvent(const EngineEvent& event);
+    void recordCursor(int x, int y);
+    void recordBounds(int screenW, int screenH, const Rect& overlayBounds);
+
+private:
+    void writeTimestamp();
+    void writeVarint(uint64_t value);
+
+    std::ofstream out;
+    std::chrono::steady_clock::time_point start;
+    uint64_t lastNs = 0;
+};
+
+class TraceReader {
+public:
+    bool open(const std::string& path);
+    const TraceHeader& header() const { return traceHeader; }
+
+    // Returns false at end of trace or on a malformed record.
+    bool next(TraceRecord& record);
+
+private:
+    bool readVarint(uint64_t& value);
+    bool readByte(uint8_t& value);
+
+    std::ifstream in;
+    TraceHeader traceHeader;
+    uint64_t lastNs = 0;
+};
+
+#endif // TRACE_H
@@ -1,8 +1,33 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <algorithm>
+
 struct Rect {
     double x, y, w, h;
 };
 
+inline bool sameRect(const Rect& a, const Rect& b) {
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+// Bounding box of both; an empty side yields the other
+inline Rect unionRect(const Rect& a, const Rect& b) {
+    if (a.w <= 0.0 || a.h <= 0.0) return b;
+    if (b.w <= 0.0 || b.h <= 0.0) return a;
+    const double x0 = std::min(a.x, b.x);
+    const double y0 = std::min(a.y, b.y);
+    return {x0, y0, std::max(a.x + a.w, b.x + b.w) - x0, std::max(a.y + a.h, b.y + b.h) - y0};
+}
+
+// Overlap of both, or an empty rect at the origin
+inline Rect intersectRect(const Rect& a, const Rect& b) {
+    const double x0 = std::max(a.x, b.x);
+    const double y0 = std::max(a.y, b.y);
+    const double x1 = std::min(a.x + a.w, b.x + b.w);
+    const double y1 = std::min(a.y + a.h, b.y + b.h);
+    if (x1 <= x0 || y1 <= y0) return {0.0, 0.0, 0.0, 0.0};
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
 #endif // TYPES_H
@@ -1,17 +1,23 @@
 #include "core/Logger.h"
 #include "core/Config.h"
+#include "core/Keymap.h"
 #include <cstring>
 #include "core/Engine.h"
+#include "core/Trace.h"
 #include "platform/linux/X11Platform.h"
 
 int main(int argc, char* argv[]) {
     Config::loadConfig();
+    Keymap::load();
     LOG_INFO("Starting KeyNav (Phase 2 - Global Input)...");
     
     bool useEvdev = false;
+    const char* recordPath = nullptr;
     for (int i = 1; i < argc; ++i) {
         if (std::strcmp(argv[i], "--evdev") == 0) {
             useEvdev = true;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
         }
     }
     
@@ -32,6 +38,16 @@ int main(int argc, char* argv[]) {
         LOG_ERROR("Failed to initialize platform.");
         return 1;
     }
+
+    // Optional session trace for replay benchmarking (see tests/TraceReplay.cpp)
+    TraceWriter recorder;
+    if (recordPath) {
+        int screenW, screenH;
+        platform.getScreenSize(screenW, screenH);
+        if (recorder.open(recordPath, TraceHeader::fromConfig(screenW, screenH))) {
+            engine.setRecorder(&recorder);
+        }
+    }
     
     // Engine runs the platform loop
     platform.run();
@@ -0,0 +1,112 @@
+#include "CursorGlide.h"
+#include "../../core/Logger.h"
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+CursorGlide::CursorGlide(Move move) : move(std::move(move)) {}
+
+CursorGlide::~CursorGlide() {
+    if (timerFd >= 0) close(timerFd);
+}
+
+bool CursorGlide::initialize() {
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFd < 0) {
+        LOG_ERROR("CursorGlide: timerfd_create failed: ", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+double CursorGlide::ease(double t) {
+    t = std::min(std::max(t, 0.0), 1.0);
+    const double rest = 1.0 - t;
+    return 1.0 - rest * rest * rest;
+}
+
+void CursorGlide::glideTo(int fromX, int fromY, int x, int y, Clock::time_point now) {
+    targetX = x;
+    targetY = y;
+
+    if (timerFd < 0 || duration.count() <= 0) {
+        gliding = false;
+        lastX = lastY = -1;
+        moveTo(x, y);
+        return;
+    }
+
+    if (!gliding) {
+        currentX = fromX;
+        currentY = fromY;
+        lastX = lastY = -1;
+    }
+    startX = currentX;
+    startY = currentY;
+    start = now;
+
+    if (!gliding) {
+        gliding = true;
+        arm(true);
+    }
+    // The first frame goes out now rather than one interval late.
+    advance(now);
+}
+
+bool CursorGlide::advance(Clock::time_point now) {
+    if (!gliding) return false;
+
+    const double t = std::chrono::duration<double>(now - start).count() /
+                     std::chrono::duration<double>(duration).count();
+    if (t >= 1.0) {
+        finish();
+        return false;
+    }
+
+    // Progress follows the clock, not the frame count, so late frames catch up.
+    const double k = ease(t);
+    moveTo(startX + (targetX - startX) * k, startY + (targetY - startY) * k);
+    return true;
+}
+
+void CursorGlide::dispatch() {
+    uint64_t expirations = 0;
+    while (read(timerFd, &expirations, sizeof(expirations)) > 0) {}
+    advance(Clock::now());
+}
+
+void CursorGlide::finish() {
+    if (!gliding) return;
+    gliding = false;
+    arm(false);
+    moveTo(targetX, targetY);
+}
+
+void CursorGlide::arm(bool running) {
+    struct itimerspec spec;
+    std::memset(&spec, 0, sizeof(spec));
+    if (running) {
+        const int64_t ns = std::max<int64_t>(frameInterval.count(), 1000000);
+        spec.it_interval.tv_sec = (time_t)(ns / 1000000000LL);
+        spec.it_interval.tv_nsec = (long)(ns % 1000000000LL);
+        spec.it_value = spec.it_interval;
+    }
+    if (timerfd_settime(timerFd, 0, &spec, nullptr) < 0) {
+        LOG_ERROR("CursorGlide: timerfd_settime failed: ", strerror(errno));
+    }
+}
+
+void CursorGlide::moveTo(double x, double y) {
+    currentX = x;
+    currentY = y;
+    const int px = (int)std::lround(x);
+    const int py = (int)std::lround(y);
+    if (px == lastX && py == lastY) return;
+    lastX = px;
+    lastY = py;
+    move(px, py);
+}
@@ -0,0 +1,63 @@
+#ifndef CURSORGLIDE_H
+#define CURSORGLIDE_H
+
+#include <chrono>
+#include <functional>
+
+// Animates the pointer to a target along an ease-out curve, one move per
+// display refresh, from a periodic timerfd polled by the owning event loop.
+// Nothing sleeps: keys dispatched between frames retarget or finish the glide
+// on the same thread, so they never wait for the animation.
+class CursorGlide {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Move = std::function<void(int x, int y)>;
+
+    explicit CursorGlide(Move move);
+    ~CursorGlide();
+
+    bool initialize();
+
+    // Readable once per frame while a glide is running; poll it in the event loop.
+    int fd() const { return timerFd; }
+
+    void setDuration(std::chrono::milliseconds value) { duration = value; }
+    void setFrameInterval(std::chrono::nanoseconds value) { frameInterval = value; }
+
+    bool active() const { return gliding; }
+
+    // Heads for (x, y). A running glide turns towards it from wherever it has
+    // got to; otherwise the glide starts at (fromX, fromY). Moves at once when
+    // there is no timer or no duration.
+    void glideTo(int fromX, int fromY, int x, int y, Clock::time_point now = Clock::now());
+
+    // Moves to the position due at `now`. Returns false once the target is reached.
+    bool advance(Clock::time_point now);
+
+    // Emits the next frame. Call when fd() is readable.
+    void dispatch();
+
+    // Jumps to the target and stops, e.g. before a click lands.
+    void finish();
+
+    // Ease-out cubic: fast start, gentle arrival. `t` in [0, 1].
+    static double ease(double t);
+
+private:
+    void arm(bool running);
+    void moveTo(double x, double y);
+
+    Move move;
+    int timerFd = -1;
+    std::chrono::milliseconds duration{120};
+    std::chrono::nanoseconds frameInterval{16666667}; // 60 Hz
+
+    bool gliding = false;
+    Clock::time_point start;
+    double startX = 0.0, startY = 0.0;
+    double currentX = 0.0, currentY = 0.0;
+    int targetX = 0, targetY = 0;
+    int lastX = -1, lastY = -1; // Last position sent, to skip duplicate moves
+};
+
+#endif // CURSORGLIDE_H
@@ -0,0 +1,45 @@
+#ifndef EVDEVFRAME_H
+#define EVDEVFRAME_H
+
+#include <linux/input.h>
+#include <unistd.h>
+#include <cstddef>
+
+// Events for one device, terminated by SYN_REPORT and written with a single
+// write(), so a cursor move or a batch of key releases costs one syscall per
+// device no matter how many events it holds.
+class EvdevFrame {
+public:
+    static constexpr size_t MAX_EVENTS = 32;
+
+    // Events past MAX_EVENTS - 1 are dropped; the last slot is the report.
+    void add(int type, int code, int value) {
+        if (count < MAX_EVENTS - 1) append(type, code, value);
+    }
+
+    bool empty() const { return count == 0; }
+
+    // Appends SYN_REPORT and writes the frame. Returns false if the write
+    // failed or was short.
+    bool submit(int fd) {
+        append(EV_SYN, SYN_REPORT, 0);
+        const ssize_t size = (ssize_t)(count * sizeof(struct input_event));
+        const bool written = write(fd, events, size) == size;
+        count = 0;
+        return written;
+    }
+
+private:
+    void append(int type, int code, int value) {
+        struct input_event& ev = events[count++];
+        ev = {};
+        ev.type = (__u16)type;
+        ev.code = (__u16)code;
+        ev.value = value;
+    }
+
+    struct input_event events[MAX_EVENTS];
+    size_t count = 0;
+};
+
+#endif // EVDEVFRAME_H
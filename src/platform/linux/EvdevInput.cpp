@@ -1,5 +1,6 @@
 #include "EvdevInput.h"
-#include "../../core/Engine.h"
+#include "EvdevFrame.h"
+#include "../../core/Config.h"
 #include <iostream>
 #include "../../core/Logger.h"
 #include <fcntl.h>
@@ -7,13 +8,19 @@
 #include <linux/input.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
-#include <glob.h>
-#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
 #include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <cmath>
 #include <dirent.h>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <utility>
 #include <linux/uinput.h>
 
 #ifndef NLONGS
@@ -23,13 +30,38 @@
 #define TEST_BIT(bit, array) ((array)[(bit) / (8 * sizeof(long))] & (1L << ((bit) % (8 * sizeof(long)))))
 #endif
 
-EvdevInput::EvdevInput(Engine* e) : engine(e) {}
+namespace {
+constexpr int MAX_EVENTS_PER_WAKEUP = 16;
+}
+
+EvdevInput::EvdevInput(EventQueue* queue, std::string inputDir, std::string sysfsDir)
+    : events(queue), keymap(Keymap::current()), inputDir(std::move(inputDir)), sysfsDir(std::move(sysfsDir)) {}
 
 EvdevInput::~EvdevInput() {
     running = false;
+    if (stopFd >= 0) {
+        uint64_t one = 1;
+        write(stopFd, &one, sizeof(one));
+    }
     if (inputThread.joinable()) inputThread.join();
+    if (keystrokes() > 0) {
+        LOG_INFO("EvdevInput: ", keystrokes(), " keystrokes read with ", inputSyscalls(),
+                 " syscalls (", syscallsPerKeystroke(), " per keystroke)");
+    }
+    const InjectionCost moves = injectionCost(Injection::Move);
+    const InjectionCost clicks = injectionCost(Injection::Click);
+    const InjectionCost ungrabs = injectionCost(Injection::Ungrab);
+    if (moves.operations + clicks.operations + ungrabs.operations > 0) {
+        LOG_INFO("EvdevInput: Injection writes: ", moves.writes, " for ", moves.operations, " moves, ",
+                 clicks.writes, " for ", clicks.operations, " button steps, ",
+                 ungrabs.writes, " for ", ungrabs.operations, " deactivations");
+    }
+    injector.flush(); // Never leave a virtual button pressed
     closeDevices();
     destroyVirtualMouse();
+    if (inotifyFd >= 0) close(inotifyFd);
+    if (stopFd >= 0) close(stopFd);
+    if (epollFd >= 0) close(epollFd);
 }
 
 bool EvdevInput::initialize(int screenW, int screenH) {
@@ -37,17 +69,63 @@ bool EvdevInput::initialize(int screenW, int screenH) {
     sHeight = screenH;
     openDevices();
     setupVirtualMouse(screenW, screenH);
+    injector.initialize();
 
-    if (deviceFds.empty()) {
+    if (devices.empty()) {
         LOG_ERROR("EvdevInput: No keyboard devices found. Are you running with sudo?");
         return false;
     }
-    
+    return start();
+}
+
+bool EvdevInput::start() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (epollFd < 0 || stopFd < 0 || inotifyFd < 0) {
+        LOG_ERROR("EvdevInput: Failed to set up the event loop: ", strerror(errno));
+        return false;
+    }
+
+    // IN_ATTRIB catches nodes that were not yet readable at IN_CREATE, before
+    // udev applied their permissions.
+    if (inotify_add_watch(inotifyFd, inputDir.c_str(), IN_CREATE | IN_ATTRIB | IN_DELETE) < 0) {
+        LOG_WARN("EvdevInput: Cannot watch ", inputDir, " (", strerror(errno), "). Keyboards plugged in later will be missed.");
+    }
+
+    auto watch = [this](int fd) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == 0;
+    };
+    bool watching = watch(stopFd) && watch(inotifyFd);
+    if (injector.fd() >= 0) watching = watching && watch(injector.fd());
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex);
+        for (const Device& device : devices) watching = watching && watch(device.fd);
+    }
+    if (!watching) {
+        LOG_ERROR("EvdevInput: epoll_ctl failed: ", strerror(errno));
+        return false;
+    }
+
     running = true;
     inputThread = std::thread(&EvdevInput::eventLoop, this);
     return true;
 }
 
+size_t EvdevInput::keyboardCount() {
+    std::lock_guard<std::mutex> lock(deviceMutex);
+    return devices.size();
+}
+
+double EvdevInput::syscallsPerKeystroke() const {
+    const uint64_t keys = keystrokes();
+    return keys == 0 ? 0.0 : (double)inputSyscalls() / (double)keys;
+}
+
 void EvdevInput::destroyVirtualMouse() {
     if (virtualMouseFd >= 0) {
         ioctl(virtualMouseFd, UI_DEV_DESTROY);
@@ -123,23 +201,19 @@ void EvdevInput::moveMouse(int x, int y, int screenW, int screenH) {
         mappedY = (int)std::lround((double)y * (double)(dstH - 1) / (double)(srcH - 1));
     }
 
-    struct input_event ev;
-    memset(&ev, 0, sizeof(ev));
-    
-    ev.type = EV_ABS;
-    ev.code = ABS_X;
-    ev.value = mappedX;
-    write(virtualMouseFd, &ev, sizeof(ev));
-
-    ev.type = EV_ABS;
-    ev.code = ABS_Y;
-    ev.value = mappedY;
-    write(virtualMouseFd, &ev, sizeof(ev));
+    // Runs immediately unless a click is still being injected, in which
+    // case the move keeps its place behind the pending release.
+    injector.enqueue(std::chrono::milliseconds(0), [this, mappedX, mappedY] {
+        writeAbsolute(mappedX, mappedY);
+    });
+}
 
-    ev.type = EV_SYN;
-    ev.code = SYN_REPORT;
-    ev.value = 0;
-    write(virtualMouseFd, &ev, sizeof(ev));
+void EvdevInput::writeAbsolute(int mappedX, int mappedY) {
+    EvdevFrame frame;
+    frame.add(EV_ABS, ABS_X, mappedX);
+    frame.add(EV_ABS, ABS_Y, mappedY);
+    frame.submit(virtualMouseFd);
+    countInjection(Injection::Move, 1);
 }
 
 void EvdevInput::clickMouse(int button, int count) {
@@ -154,157 +228,256 @@ void EvdevInput::clickMouse(int button, int count) {
 
     LOG_INFO("EvdevInput: Virtual Click - Code: ", btnCode, " Count: ", count);
 
-    struct input_event ev;
-    memset(&ev, 0, sizeof(ev));
-
+    // Press now, release after CLICK_PRESS_RELEASE_DELAY, and space repeated
+    // clicks by DOUBLE_CLICK_DELAY; the release steps fire from eventLoop.
     for (int i = 0; i < count; ++i) {
-        // Press
-        ev.type = EV_KEY;
-        ev.code = btnCode;
-        ev.value = 1;
-        write(virtualMouseFd, &ev, sizeof(ev));
-
-        ev.type = EV_SYN;
-        ev.code = SYN_REPORT;
-        ev.value = 0;
-        write(virtualMouseFd, &ev, sizeof(ev));
-
-        // Add a small delay between press and release to simulate a real click
-        std::this_thread::sleep_for(std::chrono::milliseconds(40));
-
-        // Release
-        ev.type = EV_KEY;
-        ev.code = btnCode;
-        ev.value = 0;
-        write(virtualMouseFd, &ev, sizeof(ev));
-
-        ev.type = EV_SYN;
-        ev.code = SYN_REPORT;
-        ev.value = 0;
-        write(virtualMouseFd, &ev, sizeof(ev));
-
-        // If double-clicking, add a small pause between the clicks
-        if (count > 1 && i < count - 1) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        }
+        const auto pressDelay = (i == 0) ? std::chrono::milliseconds(0) : Config::DOUBLE_CLICK_DELAY;
+        injector.enqueue(pressDelay, [this, btnCode] { emitVirtualMouse(btnCode, 1); });
+        injector.enqueue(Config::CLICK_PRESS_RELEASE_DELAY, [this, btnCode] { emitVirtualMouse(btnCode, 0); });
     }
 }
 
+void EvdevInput::afterClick(std::function<void()> step) {
+    injector.enqueue(std::chrono::milliseconds(0), std::move(step));
+}
+
+void EvdevInput::emitVirtualMouse(int btnCode, int value) {
+    EvdevFrame frame;
+    frame.add(EV_KEY, btnCode, value);
+    frame.submit(virtualMouseFd);
+    countInjection(Injection::Click, 1);
+}
+
 void EvdevInput::openDevices() {
-    DIR* dir = opendir("/dev/input");
+    const auto begin = std::chrono::steady_clock::now();
+    DIR* dir = opendir(inputDir.c_str());
     if (!dir) return;
 
+    // Rule out touchpads, sensors, switches and the like from sysfs without
+    // opening (and waking) them; only nodes sysfs cannot describe are probed blind.
+    size_t nodeCount = 0;
+    std::vector<std::string> candidates;
     struct dirent* ent;
-    std::vector<ino_t> openedInodes;
-
     while ((ent = readdir(dir)) != NULL) {
         if (strncmp(ent->d_name, "event", 5) != 0) continue;
+        ++nodeCount;
+        if (sysfsCapability(ent->d_name) != KeyCapability::Other) candidates.push_back(ent->d_name);
+    }
+    closedir(dir);
+    std::sort(candidates.begin(), candidates.end());
 
-        char path[PATH_MAX];
-        snprintf(path, sizeof(path), "/dev/input/%s", ent->d_name);
-
-        int fd = open(path, O_RDWR | O_NONBLOCK);
-        if (fd < 0) continue;
-
-        // Check if device has keys
-        unsigned long keyBitmask[NLONGS(KEY_CNT)];
-        memset(keyBitmask, 0, sizeof(keyBitmask));
-        if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBitmask)), keyBitmask) >= 0) {
-            // Check for a few standard keys to confirm it's a keyboard
-            bool isKeyboard = TEST_BIT(KEY_A, keyBitmask) && 
-                              TEST_BIT(KEY_Z, keyBitmask) && 
-                              TEST_BIT(KEY_ENTER, keyBitmask);
-
-            if (isKeyboard) {
-                struct stat st;
-                if (fstat(fd, &st) == 0) {
-                    if (std::find(openedInodes.begin(), openedInodes.end(), st.st_ino) != openedInodes.end()) {
-                        close(fd);
-                        continue;
-                    }
-                    openedInodes.push_back(st.st_ino);
-                }
-                LOG_INFO("EvdevInput: Found Keyboard: ", path, " (fd: ", fd, ")");
-                deviceFds.push_back(fd);
-            } else {
-                close(fd);
-            }
-        } else {
+    // Opening a node can block while its device resumes, so probe them all at once.
+    std::vector<std::future<Probe>> probes;
+    for (const std::string& name : candidates) {
+        probes.push_back(std::async(std::launch::async, [this, name] { return probeDevice(name); }));
+    }
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const Probe probe = probes[i].get();
+        if (probe.fd >= 0) addDevice(candidates[i], probe);
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    LOG_INFO("EvdevInput: Found ", keyboardCount(), " keyboards among ", nodeCount, " input nodes (",
+             candidates.size(), " opened) in ", ms, " ms");
+}
+
+bool EvdevInput::openDevice(const std::string& name) {
+    {
+        // Already open, e.g. IN_ATTRIB after the node was opened on IN_CREATE
+        std::lock_guard<std::mutex> lock(deviceMutex);
+        for (const Device& device : devices) {
+            if (device.name == name) return false;
+        }
+    }
+    if (sysfsCapability(name) == KeyCapability::Other) return false;
+
+    const Probe probe = probeDevice(name);
+    return probe.fd >= 0 && addDevice(name, probe);
+}
+
+EvdevInput::KeyCapability EvdevInput::sysfsCapability(const std::string& name) const {
+    std::ifstream file(sysfsDir + "/" + name + "/device/capabilities/key");
+    std::string keyBits;
+    if (!file || !std::getline(file, keyBits)) return KeyCapability::Unknown;
+    return isKeyboardCapability(keyBits) ? KeyCapability::Keyboard : KeyCapability::Other;
+}
+
+bool EvdevInput::isKeyboardCapability(const std::string& keyBits) {
+    // Hex longs, most significant first: bit n is in the n / BITS_PER_LONG-th word from the end.
+    std::vector<unsigned long> words;
+    std::istringstream in(keyBits);
+    std::string word;
+    while (in >> word) words.push_back(std::strtoul(word.c_str(), nullptr, 16));
+
+    const size_t bitsPerWord = 8 * sizeof(unsigned long);
+    auto test = [&](int bit) {
+        const size_t index = (size_t)bit / bitsPerWord;
+        if (index >= words.size()) return false;
+        return ((words[words.size() - 1 - index] >> (bit % bitsPerWord)) & 1ul) != 0;
+    };
+    return test(KEY_A) && test(KEY_Z) && test(KEY_ENTER);
+}
+
+EvdevInput::Probe EvdevInput::probeDevice(const std::string& name) const {
+    Probe probe;
+    const std::string path = inputDir + "/" + name;
+    int fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return probe;
+
+    // Check if device has keys
+    unsigned long keyBitmask[NLONGS(KEY_CNT)];
+    memset(keyBitmask, 0, sizeof(keyBitmask));
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBitmask)), keyBitmask) < 0) {
+        close(fd);
+        return probe;
+    }
+
+    // Check for a few standard keys to confirm it's a keyboard
+    bool isKeyboard = TEST_BIT(KEY_A, keyBitmask) &&
+                      TEST_BIT(KEY_Z, keyBitmask) &&
+                      TEST_BIT(KEY_ENTER, keyBitmask);
+    struct stat st;
+    if (!isKeyboard || fstat(fd, &st) != 0) {
+        close(fd);
+        return probe;
+    }
+    probe.fd = fd;
+    probe.inode = st.st_ino;
+    return probe;
+}
+
+bool EvdevInput::addDevice(const std::string& name, const Probe& probe) {
+    const int fd = probe.fd;
+    const std::string path = inputDir + "/" + name;
+
+    std::lock_guard<std::mutex> lock(deviceMutex);
+    for (const Device& device : devices) {
+        if (device.inode == probe.inode || device.name == name) {
             close(fd);
+            return false;
         }
     }
-    closedir(dir);
+
+    if (epollFd >= 0) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            LOG_ERROR("EvdevInput: Failed to watch ", path, ": ", strerror(errno));
+            close(fd);
+            return false;
+        }
+    }
+
+    // A keyboard plugged in while grabbed joins the grab, so its keys never reach the OS.
+    if (grabbed && ioctl(fd, EVIOCGRAB, 1) != 0) {
+        LOG_ERROR("EvdevInput: Failed to grab fd ", fd, " (", strerror(errno), "). Device will be ignored.");
+    }
+
+    LOG_INFO("EvdevInput: Found Keyboard: ", path, " (fd: ", fd, ")");
+    devices.push_back({fd, name, probe.inode, std::make_unique<EvdevReader>()});
+    return true;
+}
+
+void EvdevInput::removeDevice(int fd) {
+    std::lock_guard<std::mutex> lock(deviceMutex);
+    auto it = std::find_if(devices.begin(), devices.end(), [fd](const Device& device) { return device.fd == fd; });
+    if (it == devices.end()) return;
+
+    LOG_INFO("EvdevInput: Keyboard removed: ", inputDir, "/", it->name, " (fd: ", fd, ")");
+    if (epollFd >= 0) epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    devices.erase(it);
 }
 
 void EvdevInput::closeDevices() {
     ungrabKeyboard(); // Ensure ungrabbed
-    for (int fd : deviceFds) {
-        close(fd);
+    std::lock_guard<std::mutex> lock(deviceMutex);
+    for (const Device& device : devices) {
+        close(device.fd);
     }
-    deviceFds.clear();
+    devices.clear();
 }
 
 void EvdevInput::grabKeyboard() {
     if (grabbed) return;
-    
+
+    std::lock_guard<std::mutex> lock(deviceMutex);
     std::vector<int> successfullyGrabbed;
-    for (int fd : deviceFds) {
-        if (ioctl(fd, EVIOCGRAB, 1) == 0) {
-            successfullyGrabbed.push_back(fd);
+    for (const Device& device : devices) {
+        if (ioctl(device.fd, EVIOCGRAB, 1) == 0) {
+            successfullyGrabbed.push_back(device.fd);
         } else {
-            LOG_ERROR("EvdevInput: Failed to grab fd ", fd, " (", strerror(errno), "). Device will be ignored.");
+            LOG_ERROR("EvdevInput: Failed to grab fd ", device.fd, " (", strerror(errno), "). Device will be ignored.");
         }
     }
-    
+
     if (!successfullyGrabbed.empty()) {
         grabbed = true;
-        // We don't replace deviceFds because we need them for passive monitoring when ungrabbed.
+        // We don't drop ungrabbed devices because we need them for passive monitoring when ungrabbed.
         // But the event loop should ideally only care about grabbed ones when in grabbed mode.
         LOG_INFO("EvdevInput: Keyboard grabbed (Exclusive Mode on ", successfullyGrabbed.size(), " devices)");
     }
 }
 
-void EvdevInput::injectKeyToPhysical(int code, int value) {
-    struct input_event ev;
-    memset(&ev, 0, sizeof(ev));
-    ev.type = EV_KEY;
-    ev.code = code;
-    ev.value = value;
-    
-    struct input_event syn;
-    memset(&syn, 0, sizeof(syn));
-    syn.type = EV_SYN;
-    syn.code = SYN_REPORT;
-    syn.value = 0;
-
-    for (int fd : deviceFds) {
-        write(fd, &ev, sizeof(ev));
-        write(fd, &syn, sizeof(syn));
+// Writing a release into a keyboard updates the kernel's key state and
+// passes the release on to everyone else reading it, but the kernel drops
+// releases of keys that are not down. So only keys this device holds are
+// sent, as one frame, and most devices need no write at all.
+void EvdevInput::releaseHeldKeys(const int* keys, size_t count, Injection kind) {
+    uint64_t writes = 0;
+    std::lock_guard<std::mutex> lock(deviceMutex);
+    for (const Device& device : devices) {
+        EvdevFrame frame;
+        for (size_t i = 0; i < count; ++i) {
+            if (!device.reader->isDown(keys[i])) continue;
+            frame.add(EV_KEY, keys[i], 0);
+            device.reader->markReleased(keys[i]);
+        }
+        if (frame.empty()) continue;
+        if (!frame.submit(device.fd)) {
+            LOG_ERROR("EvdevInput: Failed to release keys on fd ", device.fd, ": ", strerror(errno));
+        }
+        ++writes;
     }
+    countInjection(kind, writes);
+}
+
+void EvdevInput::countInjection(Injection kind, uint64_t writes) {
+    injectionOps[(size_t)kind].fetch_add(1, std::memory_order_relaxed);
+    injectionWrites[(size_t)kind].fetch_add(writes, std::memory_order_relaxed);
+}
+
+EvdevInput::InjectionCost EvdevInput::injectionCost(Injection kind) const {
+    InjectionCost cost;
+    cost.operations = injectionOps[(size_t)kind].load(std::memory_order_relaxed);
+    cost.writes = injectionWrites[(size_t)kind].load(std::memory_order_relaxed);
+    return cost;
 }
 
 void EvdevInput::ungrabKeyboard() {
     if (!grabbed) return;
 
-    for (int fd : deviceFds) {
-        if (ioctl(fd, EVIOCGRAB, 0) != 0) {
-            LOG_ERROR("EvdevInput: Failed to release grab on fd ", fd, ": ", strerror(errno));
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex);
+        for (const Device& device : devices) {
+            if (ioctl(device.fd, EVIOCGRAB, 0) != 0) {
+                LOG_ERROR("EvdevInput: Failed to release grab on fd ", device.fd, ": ", strerror(errno));
+            }
         }
+        grabbed = false;
     }
-    grabbed = false;
 
     // Emit "up" events to the PHYSICAL devices so the OS resets their state
-    int keysToRelease[] = { 
-        KEY_LEFTALT, KEY_RIGHTALT, 
-        KEY_LEFTCTRL, KEY_RIGHTCTRL, 
+    static const int keysToRelease[] = {
+        KEY_LEFTALT, KEY_RIGHTALT,
+        KEY_LEFTCTRL, KEY_RIGHTCTRL,
         KEY_LEFTMETA, KEY_RIGHTMETA,
         KEY_LEFTSHIFT, KEY_RIGHTSHIFT,
-        KEY_G, KEY_ESC 
+        KEY_G, KEY_ESC
     };
-    
-    for (int key : keysToRelease) {
-        injectKeyToPhysical(key, 0); // 0 = Release
-    }
+    releaseHeldKeys(keysToRelease, sizeof(keysToRelease) / sizeof(keysToRelease[0]), Injection::Ungrab);
 
     // Clear internal state tracking
     altPressed = false;
@@ -313,116 +486,165 @@ void EvdevInput::ungrabKeyboard() {
     LOG_INFO("EvdevInput: Keyboard released. (KeyNav is still running, press Activation Key to return or Ctrl+C to quit)");
 }
 
+void EvdevInput::post(EngineEventType type, char c) {
+    EngineEvent event;
+    event.type = type;
+    event.c = c;
+    event.shift = shiftPressed;
+    events->push(event);
+}
+
+void EvdevInput::postAction(KeyAction action, EngineEventType type) {
+    EngineEvent event;
+    event.type = type;
+    event.action = action;
+    events->push(event);
+}
+
 void EvdevInput::eventLoop() {
-    std::vector<struct pollfd> fds(deviceFds.size());
-    for (size_t i = 0; i < deviceFds.size(); ++i) {
-        fds[i].fd = deviceFds[i];
-        fds[i].events = POLLIN;
-    }
+    struct epoll_event ready[MAX_EVENTS_PER_WAKEUP];
 
-    struct input_event ev;
-    
     while (running) {
-        int ret = poll(fds.data(), fds.size(), 100); // 100ms timeout
-        if (ret < 0) break; // Error
-        if (ret == 0) continue; // Timeout
-
-        for (size_t i = 0; i < fds.size(); ++i) {
-            if (fds[i].revents & POLLIN) {
-                while (read(fds[i].fd, &ev, sizeof(ev)) > 0) {
-                    if (ev.type == EV_KEY) {
-                        bool pressed = (ev.value == 1);
-                        bool released = (ev.value == 0);
-                        int code = ev.code;
-
-                        // Track Modifiers state globally
-                        if (code == KEY_LEFTALT || code == KEY_RIGHTALT) {
-                            if (pressed) altPressed = true;
-                            else if (released) altPressed = false;
-                        }
-                        if (code == KEY_LEFTCTRL || code == KEY_RIGHTCTRL) {
-                            if (pressed) ctrlPressed = true;
-                            else if (released) ctrlPressed = false;
-                        }
-                        if (code == KEY_LEFTSHIFT || code == KEY_RIGHTSHIFT) {
-                            if (pressed) shiftPressed = true;
-                            else if (released) shiftPressed = false;
-                        }
-
-                        // Logic
-                        if (grabbed) {
-                            // In grabbed mode, we process all keys and they are NOT seen by the OS
-                            if (pressed) {
-                                LOG_INFO("EvdevInput: Key Pressed: ", code, " (grabbed)");
-                                if (code == KEY_ESC) {
-                                    engine->onDeactivate();
-                                }
-                                else if (code == KEY_C && ctrlPressed) {
-                                    LOG_INFO("EvdevInput: Ctrl+C detected while grabbed. Exiting...");
-                                    engine->onExit();
-                                }
-                                else if (code == KEY_BACKSPACE) {
-                                    engine->onControlKey("backspace");
-                                }
-                                else if (code == KEY_ENTER) {
-                                    engine->onControlKey("enter");
-                                }
-                                else if (code == KEY_SPACE) {
-                                    engine->onControlKey("space");
-                                }
-                                else if (code == KEY_F) {
-                                    engine->onClick(1, 1, false); // Left click, STAY
-                                }
-                            }
-                            
-                            char c = '\0';
-                            switch(code) {
-                                case KEY_A: c = 'a'; break; case KEY_B: c = 'b'; break;
-                                case KEY_C: c = 'c'; break; case KEY_D: c = 'd'; break;
-                                case KEY_E: c = 'e'; break; case KEY_F: c = 'f'; break;
-                                case KEY_G: c = 'g'; break; case KEY_H: c = 'h'; break;
-                                case KEY_I: c = 'i'; break; case KEY_J: c = 'j'; break;
-                                case KEY_K: c = 'k'; break; case KEY_L: c = 'l'; break;
-                                case KEY_M: c = 'm'; break; case KEY_N: c = 'n'; break;
-                                case KEY_O: c = 'o'; break; case KEY_P: c = 'p'; break;
-                                case KEY_Q: c = 'q'; break; case KEY_R: c = 'r'; break;
-                                case KEY_S: c = 's'; break; case KEY_T: c = 't'; break;
-                                case KEY_U: c = 'u'; break; case KEY_V: c = 'v'; break;
-                                case KEY_W: c = 'w'; break; case KEY_X: c = 'x'; break;
-                                case KEY_Y: c = 'y'; break; case KEY_Z: c = 'z'; break;
-                                case KEY_1: c = '1'; break; case KEY_2: c = '2'; break;
-                                case KEY_3: c = '3'; break; case KEY_4: c = '4'; break;
-                                case KEY_5: c = '5'; break; case KEY_6: c = '6'; break;
-                                case KEY_7: c = '7'; break; case KEY_8: c = '8'; break;
-                                case KEY_9: c = '9'; break; case KEY_0: c = '0'; break;
-                            }
-                            if (c != '\0') {
-                                if (pressed) engine->onChar(c, shiftPressed);
-                                else if (released) engine->onKeyRelease(c);
-                            }
-                        } else {
-                            // Passive Monitoring (Activation)
-                            // In this state, the OS also sees these keys! 
-                            // We only look for the trigger to START grabbing.
-                            if (pressed && (code == KEY_RIGHTCTRL || (altPressed && code == KEY_G))) {
-                                LOG_INFO("EvdevInput: Activation Key Detected (", (code == KEY_RIGHTCTRL ? "RIGHT CTRL" : "Alt+G"), ")");
-                                
-                                // Before grabbing, we MUST "release" the activation keys in the OS's mind
-                                // otherwise they will be stuck "down" forever because we grab before the "up" event.
-                                if (code == KEY_RIGHTCTRL) injectKeyToPhysical(KEY_RIGHTCTRL, 0);
-                                if (altPressed && code == KEY_G) {
-                                    injectKeyToPhysical(KEY_LEFTALT, 0);
-                                    injectKeyToPhysical(KEY_RIGHTALT, 0);
-                                    injectKeyToPhysical(KEY_G, 0);
-                                }
-
-                                grabKeyboard();
-                                engine->onActivate();
-                            }
-                        }
+        // No timeout: every wakeup is input, a due click step, a change under
+        // inputDir or shutdown.
+        int count = epoll_wait(epollFd, ready, MAX_EVENTS_PER_WAKEUP, -1);
+        wakeupCount.fetch_add(1, std::memory_order_relaxed);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("EvdevInput: epoll_wait failed: ", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = ready[i].data.fd;
+            if (fd == stopFd) {
+                return;
+            } else if (fd == inotifyFd) {
+                handleDirectoryChanges();
+            } else if (fd == injector.fd()) {
+                injector.dispatch();
+            } else if (ready[i].events & EPOLLIN) {
+                readDevice(fd);
+            } else if (ready[i].events & (EPOLLERR | EPOLLHUP)) {
+                removeDevice(fd); // Unplugged
+            }
+        }
+    }
+}
+
+void EvdevInput::handleDirectoryChanges() {
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t offset = 0; offset < length;) {
+            const struct inotify_event* change = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            offset += sizeof(struct inotify_event) + change->len;
+            if (change->len == 0 || strncmp(change->name, "event", 5) != 0) continue;
+
+            if (change->mask & (IN_CREATE | IN_ATTRIB)) {
+                openDevice(change->name);
+            } else if (change->mask & IN_DELETE) {
+                int fd = -1;
+                {
+                    std::lock_guard<std::mutex> lock(deviceMutex);
+                    for (const Device& device : devices) {
+                        if (device.name == change->name) fd = device.fd;
                     }
                 }
+                if (fd >= 0) removeDevice(fd);
             }
         }
     }
 }
+
+void EvdevInput::readDevice(int fd) {
+    // Only this thread adds or removes devices, so the reader stays valid
+    // without holding the lock while frames are handled.
+    EvdevReader* reader = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex);
+        for (const Device& device : devices) {
+            if (device.fd == fd) reader = device.reader.get();
+        }
+    }
+    if (!reader) return;
+
+    const uint64_t readsBefore = reader->reads();
+    const bool present = reader->readFrames(fd, [this](const struct input_event* frame, size_t count) {
+        handleFrame(frame, count);
+    });
+    readCount.fetch_add(reader->reads() - readsBefore, std::memory_order_relaxed);
+    if (!present) removeDevice(fd); // Unplugged mid-read
+}
+
+void EvdevInput::handleFrame(const struct input_event* frame, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (frame[i].type == EV_KEY) handleKey(frame[i]);
+    }
+}
+
+void EvdevInput::handleKey(const struct input_event& ev) {
+    bool pressed = (ev.value == 1);
+    bool released = (ev.value == 0);
+    int code = ev.code;
+    if (pressed) keystrokeCount.fetch_add(1, std::memory_order_relaxed);
+
+    // Track Modifiers state globally
+    if (code == KEY_LEFTALT || code == KEY_RIGHTALT) {
+        if (pressed) altPressed = true;
+        else if (released) altPressed = false;
+    }
+    if (code == KEY_LEFTCTRL || code == KEY_RIGHTCTRL) {
+        if (pressed) ctrlPressed = true;
+        else if (released) ctrlPressed = false;
+    }
+    if (code == KEY_LEFTSHIFT || code == KEY_RIGHTSHIFT) {
+        if (pressed) shiftPressed = true;
+        else if (released) shiftPressed = false;
+    }
+
+    // Logic
+    if (grabbed) {
+        // In grabbed mode, we process all keys and they are NOT seen by the OS
+        const KeyBinding& binding = keymap.evdev(code);
+        if (pressed) {
+            LOG_INFO("EvdevInput: Key Pressed: ", code, " (grabbed)");
+            if (binding.c == 'c' && ctrlPressed) {
+                LOG_INFO("EvdevInput: Ctrl+C detected while grabbed. Exiting...");
+                post(EngineEventType::Exit);
+            } else if (binding.action != KeyAction::Unbound) {
+                postAction(binding.action);
+            }
+        } else if (isDirection(binding.action)) {
+            // Direction keys steer precision motion, which needs their
+            // releases, and their autorepeats to pick up a key already held.
+            postAction(binding.action, released ? EngineEventType::ActionRelease : EngineEventType::Action);
+        }
+
+        if (binding.c != '\0') {
+            if (pressed) post(EngineEventType::Char, binding.c);
+            else if (released) post(EngineEventType::CharRelease, binding.c);
+        }
+    } else {
+        // Passive Monitoring (Activation)
+        // In this state, the OS also sees these keys! 
+        // We only look for the trigger to START grabbing.
+        if (pressed && (code == KEY_RIGHTCTRL || (altPressed && code == KEY_G))) {
+            LOG_INFO("EvdevInput: Activation Key Detected (", (code == KEY_RIGHTCTRL ? "RIGHT CTRL" : "Alt+G"), ")");
+            
+            // Before grabbing, we MUST "release" the activation keys in the OS's mind
+            // otherwise they will be stuck "down" forever because we grab before the "up" event.
+            if (code == KEY_RIGHTCTRL) {
+                static const int keys[] = {KEY_RIGHTCTRL};
+                releaseHeldKeys(keys, 1, Injection::Activation);
+            } else {
+                static const int keys[] = {KEY_LEFTALT, KEY_RIGHTALT, KEY_G};
+                releaseHeldKeys(keys, 3, Injection::Activation);
+            }
+
+            // Grab here rather than on the reactor thread so no key leaks to the OS in between.
+            grabKeyboard();
+            post(EngineEventType::Activate);
+        }
+    }
+}
@@ -2,41 +2,125 @@
 #define EVDEVINPUT_H
 
 #include "../../core/Input.h"
+#include "../../core/Keymap.h"
+#include "InjectionScheduler.h"
+#include "EventQueue.h"
+#include "EvdevReader.h"
 #include <vector>
 #include <string>
 #include <thread>
 #include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
-
-class Engine;
+#include <sys/types.h>
 
 class EvdevInput : public Input {
 public:
-    EvdevInput(Engine* e);
+    // Decoded events are pushed to `queue` and dispatched on the reactor thread.
+    // Keyboards are the event* nodes under `inputDir` whose key capabilities
+    // under `sysfsDir` include letters and Enter.
+    EvdevInput(EventQueue* queue, std::string inputDir = "/dev/input",
+               std::string sysfsDir = "/sys/class/input");
     ~EvdevInput();
 
     bool initialize(int screenW = 0, int screenH = 0) override;
     void grabKeyboard() override;
     void ungrabKeyboard() override;
 
+    // Starts the input thread. It sleeps in epoll_wait until a keyboard, the
+    // injection timer, a change under inputDir or shutdown needs it, so an
+    // idle loop never wakes up. Called by initialize().
+    bool start();
+
     // Main loop for reading events (runs in separate thread)
     void eventLoop();
 
+    // Returns from epoll_wait so far; flat while no input arrives.
+    uint64_t wakeups() const { return wakeupCount.load(std::memory_order_relaxed); }
+    size_t keyboardCount();
+
+    // Key presses seen and syscalls the input thread made to read them
+    // (epoll_wait plus device reads), grabbed or passively watching.
+    uint64_t keystrokes() const { return keystrokeCount.load(std::memory_order_relaxed); }
+    uint64_t inputSyscalls() const { return wakeups() + readCount.load(std::memory_order_relaxed); }
+    double syscallsPerKeystroke() const;
+
+    // Kinds of events written to the virtual mouse or back into keyboards.
+    enum class Injection { Move, Click, Activation, Ungrab, Count };
+    struct InjectionCost {
+        uint64_t operations = 0;
+        uint64_t writes = 0; // One per device touched by an operation
+    };
+    InjectionCost injectionCost(Injection kind) const;
+
+    // Whether a sysfs capabilities/key bitmap ("10000 ... fffffffffffffffe")
+    // has the keys that mark a keyboard.
+    static bool isKeyboardCapability(const std::string& keyBits);
+
 private:
+    struct Device {
+        int fd;
+        std::string name; // Node name under inputDir, e.g. "event3"
+        ino_t inode;
+        std::unique_ptr<EvdevReader> reader;
+    };
+
+    void post(EngineEventType type, char c = '\0');
+    void postAction(KeyAction action, EngineEventType type = EngineEventType::Action);
+
+    enum class KeyCapability { Keyboard, Other, Unknown };
+
+    // Keyboard node opened and confirmed with EVIOCGBIT; fd is -1 otherwise.
+    struct Probe {
+        int fd = -1;
+        ino_t inode = 0;
+    };
+
     void openDevices();
+    bool openDevice(const std::string& name);
+    KeyCapability sysfsCapability(const std::string& name) const;
+    Probe probeDevice(const std::string& name) const;
+    bool addDevice(const std::string& name, const Probe& probe);
+    void removeDevice(int fd);
     void closeDevices();
-    void injectKeyToPhysical(int code, int value);
+    void handleDirectoryChanges();
+    void readDevice(int fd);
+    void handleFrame(const struct input_event* frame, size_t count);
+    void handleKey(const struct input_event& ev);
+    void releaseHeldKeys(const int* keys, size_t count, Injection kind);
+    void countInjection(Injection kind, uint64_t writes);
     
     // Virtual Mouse for Wayland support
     void setupVirtualMouse(int w, int h);
     void moveMouse(int x, int y, int screenW, int screenH) override;
     void clickMouse(int button, int count) override;
+    void afterClick(std::function<void()> step) override;
+    void emitVirtualMouse(int btnCode, int value);
+    void writeAbsolute(int mappedX, int mappedY);
     void destroyVirtualMouse();
 
-    Engine* engine;
-    std::vector<int> deviceFds;
+    EventQueue* events;
+    const Keymap& keymap;
+    std::string inputDir;
+    std::string sysfsDir;
+
+    // Added and removed on the input thread; grab, ungrab and key injection
+    // also walk it from the reactor thread.
+    std::vector<Device> devices;
+    std::mutex deviceMutex;
+
+    int epollFd = -1;
+    int stopFd = -1;    // eventfd, written once on shutdown
+    int inotifyFd = -1; // Watches inputDir for keyboards coming and going
+    std::atomic<uint64_t> wakeupCount{0};
+    std::atomic<uint64_t> readCount{0};
+    std::atomic<uint64_t> keystrokeCount{0};
+    std::atomic<uint64_t> injectionOps[(size_t)Injection::Count] = {};
+    std::atomic<uint64_t> injectionWrites[(size_t)Injection::Count] = {};
     int virtualMouseFd = -1;
     int sWidth = 0, sHeight = 0;
+    InjectionScheduler injector; // Timed click steps, fired from eventLoop
     std::thread inputThread;
     std::atomic<bool> running{false};
     std::atomic<bool> grabbed{false};
@@ -0,0 +1,71 @@
+#include "EvdevReader.h"
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+bool EvdevReader::readFrames(int fd, const FrameHandler& onFrame) {
+    for (;;) {
+        const size_t room = BATCH_EVENTS - carried;
+        ssize_t n = read(fd, batch + carried, room * sizeof(struct input_event));
+        ++readCount;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        if (n == 0) return false;
+
+        const size_t count = carried + (size_t)n / sizeof(struct input_event);
+        size_t frameStart = 0;
+        for (size_t i = carried; i < count; ++i) {
+            const struct input_event& ev = batch[i];
+            if (ev.type != EV_SYN) continue;
+
+            if (ev.code == SYN_DROPPED) {
+                // Events since the last report are incomplete; the kernel
+                // resumes with a full frame after the next SYN_REPORT.
+                dropping = true;
+                frameStart = i + 1;
+            } else if (ev.code == SYN_REPORT) {
+                if (!dropping) dispatch(batch + frameStart, i + 1 - frameStart, onFrame);
+                dropping = false;
+                frameStart = i + 1;
+            }
+        }
+
+        // Keep an unfinished frame at the front for the next read. A frame
+        // larger than the whole batch is handed out in pieces.
+        carried = count - frameStart;
+        if (carried == BATCH_EVENTS) {
+            if (!dropping) dispatch(batch, carried, onFrame);
+            carried = 0;
+        } else if (carried > 0 && frameStart > 0) {
+            std::memmove(batch, batch + frameStart, carried * sizeof(struct input_event));
+        }
+
+        if ((size_t)n < room * sizeof(struct input_event)) return true;
+    }
+}
+
+void EvdevReader::dispatch(const struct input_event* frame, size_t count, const FrameHandler& onFrame) {
+    for (size_t i = 0; i < count; ++i) {
+        const struct input_event& ev = frame[i];
+        if (ev.type != EV_KEY || ev.code >= KEY_CNT) continue;
+        const uint64_t bit = 1ull << (ev.code % 64);
+        if (ev.value == 0) {
+            keysDown[ev.code / 64].fetch_and(~bit, std::memory_order_relaxed);
+        } else {
+            keysDown[ev.code / 64].fetch_or(bit, std::memory_order_relaxed);
+        }
+    }
+    onFrame(frame, count);
+}
+
+bool EvdevReader::isDown(int code) const {
+    if (code < 0 || code >= KEY_CNT) return false;
+    return keysDown[code / 64].load(std::memory_order_relaxed) & (1ull << (code % 64));
+}
+
+void EvdevReader::markReleased(int code) {
+    if (code < 0 || code >= KEY_CNT) return;
+    keysDown[code / 64].fetch_and(~(1ull << (code % 64)), std::memory_order_relaxed);
+}
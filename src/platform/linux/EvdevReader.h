@@ -0,0 +1,47 @@
+#ifndef EVDEVREADER_H
+#define EVDEVREADER_H
+
+#include <linux/input.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Reads one evdev node in batches and hands its events out a SYN_REPORT
+// frame at a time. A key press arrives as EV_MSC, EV_KEY and EV_SYN, so a
+// single read() of a whole batch replaces three or more reads per key.
+class EvdevReader {
+public:
+    static constexpr size_t BATCH_EVENTS = 64;
+
+    // Called with every event of one frame, SYN_REPORT included.
+    using FrameHandler = std::function<void(const struct input_event* events, size_t count)>;
+
+    // Reads what is pending on `fd` and dispatches each complete frame. It
+    // only reads again when a read filled the whole batch, so a level
+    // triggered poller pays one read per wakeup. Returns false once the
+    // device is gone.
+    bool readFrames(int fd, const FrameHandler& onFrame);
+
+    // read() calls so far, including ones that returned nothing.
+    uint64_t reads() const { return readCount; }
+
+    // Whether key `code` is held on this device as of the frames read so
+    // far. Safe to call from any thread.
+    bool isDown(int code) const;
+
+    // Records a release injected back into the device, which the kernel
+    // applies to its key state at once.
+    void markReleased(int code);
+
+private:
+    void dispatch(const struct input_event* frame, size_t count, const FrameHandler& onFrame);
+
+    std::atomic<uint64_t> keysDown[(KEY_CNT + 63) / 64] = {};
+    struct input_event batch[BATCH_EVENTS];
+    size_t carried = 0;    // Leading events of a frame the last read cut off
+    bool dropping = false; // Kernel buffer overflowed; skip to the next SYN_REPORT
+    uint64_t readCount = 0;
+};
+
+#endif // EVDEVREADER_H
@@ -0,0 +1,51 @@
+#include "EventQueue.h"
+#include "../../core/Logger.h"
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+EventQueue::EventQueue() {}
+
+EventQueue::~EventQueue() {
+    if (wakeFd >= 0) close(wakeFd);
+}
+
+bool EventQueue::initialize() {
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        LOG_ERROR("EventQueue: eventfd failed: ", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void EventQueue::push(const EngineEvent& event) {
+    if (!ring.push(event)) {
+        // The reactor is stalled; apply backpressure rather than drop a key.
+        LOG_WARN("EventQueue: Ring full, waiting for the reactor to drain");
+        while (!ring.push(event)) std::this_thread::yield();
+    }
+
+    // Only the first push after a drain pays for the wakeup syscall.
+    if (!wakePending.exchange(true, std::memory_order_acq_rel)) {
+        uint64_t one = 1;
+        write(wakeFd, &one, sizeof(one));
+    }
+}
+
+void EventQueue::drain(const std::function<void(const EngineEvent&)>& handler) {
+    uint64_t count = 0;
+    while (read(wakeFd, &count, sizeof(count)) > 0) {}
+
+    // Clear before draining: anything pushed from here on either gets popped
+    // below or re-arms the eventfd.
+    wakePending.store(false, std::memory_order_release);
+
+    EngineEvent event;
+    while (ring.pop(event)) {
+        handler(event);
+    }
+}
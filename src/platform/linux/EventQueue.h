@@ -0,0 +1,33 @@
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#include "../../core/EngineEvent.h"
+#include "../../core/SpscQueue.h"
+#include <atomic>
+#include <functional>
+
+// Hands decoded input events from one input thread to the reactor thread.
+// The ring is lock-free; an eventfd wakes the reactor at most once per batch.
+class EventQueue {
+public:
+    EventQueue();
+    ~EventQueue();
+
+    bool initialize();
+
+    // Readable when events are pending; register it with the reactor.
+    int fd() const { return wakeFd; }
+
+    // Producer side (input thread only).
+    void push(const EngineEvent& event);
+
+    // Consumer side (reactor thread only). Call when fd() is readable.
+    void drain(const std::function<void(const EngineEvent&)>& handler);
+
+private:
+    SpscQueue<EngineEvent, 256> ring;
+    std::atomic<bool> wakePending{false};
+    int wakeFd = -1;
+};
+
+#endif // EVENTQUEUE_H
@@ -0,0 +1,111 @@
+#include "FramePrerenderer.h"
+#include "../../core/Logger.h"
+#include "../../render/GridRenderer.h"
+#include <cmath>
+
+FramePrerenderer::FramePrerenderer(DrawFn d) : draw(std::move(d)) {}
+
+FramePrerenderer::~FramePrerenderer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        pending.clear();
+    }
+    cv.notify_all();
+    if (worker.joinable()) worker.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    releaseFramesLocked();
+}
+
+void FramePrerenderer::request(const std::vector<GridLayout>& candidates) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+        releaseFramesLocked();
+        pending = candidates;
+        if (!worker.joinable()) {
+            worker = std::thread(&FramePrerenderer::workerLoop, this);
+        }
+    }
+    cv.notify_one();
+}
+
+void FramePrerenderer::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    generation++;
+    pending.clear();
+    releaseFramesLocked();
+    if (hitCount + missCount > 0) {
+        LOG_DEBUG("FramePrerenderer: ", hitCount, " hits, ", missCount, " misses");
+    }
+}
+
+cairo_surface_t* FramePrerenderer::lookup(const GridLayout& layout, double& rootX, double& rootY) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Frame& frame : frames) {
+        if (sameLayout(frame.layout, layout)) {
+            hitCount++;
+            rootX = frame.rootX;
+            rootY = frame.rootY;
+            return cairo_surface_reference(frame.surface);
+        }
+    }
+    missCount++;
+    return nullptr;
+}
+
+void FramePrerenderer::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this]() { return stopping || !pending.empty(); });
+        if (stopping) return;
+
+        const unsigned jobGeneration = generation;
+        const GridLayout layout = pending.front();
+        pending.erase(pending.begin());
+        lock.unlock();
+
+        // Exactly what a direct render draws, border and overhanging labels
+        // included, since render() clears that whole area before the blit.
+        const Rect extent = GridRenderer::drawnExtent(GridFrame{layout, false});
+        const double originX = std::floor(extent.x);
+        const double originY = std::floor(extent.y);
+        const int width = (int)std::ceil(extent.x + extent.w - originX);
+        const int height = (int)std::ceil(extent.y + extent.h - originY);
+
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+        if (cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS) {
+            cairo_t* cr = cairo_create(surface);
+            draw(cr, layout.translated(-originX, -originY));
+            cairo_destroy(cr);
+            cairo_surface_flush(surface);
+        } else {
+            LOG_WARN("FramePrerenderer: Failed to allocate ", width, "x", height, " patch");
+            cairo_surface_destroy(surface);
+            surface = nullptr;
+        }
+
+        lock.lock();
+        if (!surface) continue;
+        if (jobGeneration != generation) {
+            cairo_surface_destroy(surface);
+            continue;
+        }
+        frames.push_back({layout, surface, originX, originY});
+    }
+}
+
+void FramePrerenderer::releaseFramesLocked() {
+    for (Frame& frame : frames) {
+        cairo_surface_destroy(frame.surface);
+    }
+    frames.clear();
+}
+
+bool FramePrerenderer::sameLayout(const GridLayout& a, const GridLayout& b) {
+    const Rect& ra = a.bounds();
+    const Rect& rb = b.bounds();
+    return a.rows() == b.rows() && a.cols() == b.cols() &&
+           ra.x == rb.x && ra.y == rb.y && ra.w == rb.w && ra.h == rb.h;
+}
@@ -0,0 +1,58 @@
+#ifndef FRAMEPRERENDERER_H
+#define FRAMEPRERENDERER_H
+
+#include "../../core/GridLayout.h"
+#include <cairo.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Renders candidate grid frames on a worker thread, so that the keystroke
+// that selects one of them only has to blit a finished patch.
+//
+// Each frame is an ARGB image surface covering GridRenderer::drawnExtent()
+// of the candidate, the same pixels a direct render touches. Frames are
+// keyed by the layout in root coordinates. A new request() drops all
+// earlier frames; clear() logs the lookup hits and misses so far.
+class FramePrerenderer {
+public:
+    // Draws `layout` onto a transparent surface whose origin is the patch origin
+    using DrawFn = std::function<void(cairo_t* cr, const GridLayout& layout)>;
+
+    explicit FramePrerenderer(DrawFn draw);
+    ~FramePrerenderer();
+
+    void request(const std::vector<GridLayout>& candidates);
+    void clear();
+
+    // Non-blocking. On a hit, returns a new reference to the patch (the caller
+    // destroys it) and the root-coordinate position to paint it at.
+    cairo_surface_t* lookup(const GridLayout& layout, double& rootX, double& rootY);
+
+private:
+    struct Frame {
+        GridLayout layout;
+        cairo_surface_t* surface = nullptr;
+        double rootX = 0.0;
+        double rootY = 0.0;
+    };
+
+    void workerLoop();
+    void releaseFramesLocked();
+    static bool sameLayout(const GridLayout& a, const GridLayout& b);
+
+    DrawFn draw;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    unsigned generation = 0;          // Bumped by request()/clear(); stale results are dropped
+    std::vector<GridLayout> pending;  // Not yet rendered, for the current generation
+    std::vector<Frame> frames;        // Finished, for the current generation
+    int hitCount = 0;
+    int missCount = 0;
+};
+
+#endif // FRAMEPRERENDERER_H
@@ -0,0 +1,90 @@
+#include "InjectionScheduler.h"
+#include "../../core/Logger.h"
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+InjectionScheduler::InjectionScheduler() {}
+
+InjectionScheduler::~InjectionScheduler() {
+    if (timerFd >= 0) close(timerFd);
+}
+
+bool InjectionScheduler::initialize() {
+    // steady_clock is CLOCK_MONOTONIC on Linux, so due times arm the timer directly.
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFd < 0) {
+        LOG_ERROR("InjectionScheduler: timerfd_create failed: ", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void InjectionScheduler::enqueue(std::chrono::milliseconds delay, Action action) {
+    const auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        const auto due = (queue.empty() ? now : queue.back().due) + delay;
+        if (timerFd >= 0 && (running || !queue.empty() || due > now)) {
+            queue.push_back({due, std::move(action)});
+            // A running dispatch() picks the step up, or re-arms, once its step returns.
+            if (queue.size() == 1 && !running) armLocked();
+            return;
+        }
+    }
+
+    // Due now with nothing ahead of it or in flight (or no timer to fire
+    // from): run on the caller.
+    action();
+}
+
+void InjectionScheduler::dispatch() {
+    uint64_t expirations = 0;
+    while (read(timerFd, &expirations, sizeof(expirations)) > 0) {}
+
+    while (true) {
+        Action action;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (queue.empty() || queue.front().due > std::chrono::steady_clock::now()) {
+                running = false;
+                if (!queue.empty()) armLocked();
+                return;
+            }
+            action = std::move(queue.front().action);
+            queue.pop_front();
+            running = true;
+        }
+        action();
+    }
+}
+
+void InjectionScheduler::flush() {
+    std::deque<Step> pending;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.swap(queue);
+        armLocked();
+    }
+    for (auto& step : pending) step.action();
+}
+
+void InjectionScheduler::armLocked() {
+    if (timerFd < 0) return;
+
+    struct itimerspec spec;
+    std::memset(&spec, 0, sizeof(spec));
+    if (!queue.empty()) {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            queue.front().due.time_since_epoch()).count();
+        // A zero it_value disarms the timer, so never arm at exactly 0.
+        spec.it_value.tv_sec = (time_t)(ns / 1000000000LL);
+        spec.it_value.tv_nsec = (long)std::max<int64_t>(ns % 1000000000LL, 1);
+    }
+    if (timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+        LOG_ERROR("InjectionScheduler: timerfd_settime failed: ", strerror(errno));
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef INJECTIONSCHEDULER_H
+#define INJECTIONSCHEDULER_H
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// Queues timed injection steps (button press, release, SYN) and fires them
+// from the owning event loop through a timerfd, so multi-step clicks never
+// sleep on the thread that reads input.
+class InjectionScheduler {
+public:
+    using Action = std::function<void()>;
+
+    InjectionScheduler();
+    ~InjectionScheduler();
+
+    bool initialize();
+
+    // Readable when at least one queued step is due; poll it in the event loop.
+    int fd() const { return timerFd; }
+
+    // Appends a step that runs `delay` after the previously queued step, or
+    // after now when nothing is pending. Steps due immediately run on the
+    // caller only when the queue is empty and dispatch() is not running one,
+    // so steps never overlap or overtake each other.
+    void enqueue(std::chrono::milliseconds delay, Action action);
+
+    // Runs every step that is due. Call when fd() is readable.
+    void dispatch();
+
+    // Runs every pending step immediately, e.g. so no button stays pressed on shutdown.
+    void flush();
+
+private:
+    struct Step {
+        std::chrono::steady_clock::time_point due;
+        Action action;
+    };
+
+    void armLocked();
+
+    std::deque<Step> queue;
+    bool running = false; // dispatch() is running a step outside the lock
+    std::mutex queueMutex;
+    int timerFd = -1;
+};
+
+#endif // INJECTIONSCHEDULER_H
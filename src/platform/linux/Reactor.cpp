@@ -0,0 +1,166 @@
+#include "Reactor.h"
+#include "../../core/Logger.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+static_assert(sizeof(GPollFD) == sizeof(struct pollfd), "GPollFD must match struct pollfd");
+
+namespace {
+constexpr int MAX_EVENTS_PER_WAKEUP = 16;
+}
+
+Reactor::Reactor() {}
+
+Reactor::~Reactor() {
+    if (wakeFd >= 0) close(wakeFd);
+    if (epollFd >= 0) close(epollFd);
+}
+
+bool Reactor::initialize() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        LOG_ERROR("Reactor: epoll_create1 failed: ", strerror(errno));
+        return false;
+    }
+
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        LOG_ERROR("Reactor: eventfd failed: ", strerror(errno));
+        return false;
+    }
+    return add(wakeFd, [this]() {
+        uint64_t count = 0;
+        while (read(wakeFd, &count, sizeof(count)) > 0) {}
+        runPosted();
+    });
+}
+
+bool Reactor::add(int fd, Handler onReadable) {
+    if (fd < 0) return false;
+
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        LOG_ERROR("Reactor: Failed to watch fd ", fd, ": ", strerror(errno));
+        return false;
+    }
+    handlers[fd] = std::move(onReadable);
+    return true;
+}
+
+void Reactor::remove(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    handlers.erase(fd);
+}
+
+void Reactor::stop() {
+    running = false;
+    wake();
+}
+
+void Reactor::post(Handler handler) {
+    {
+        std::lock_guard<std::mutex> lock(postedMutex);
+        posted.push_back(std::move(handler));
+    }
+    wake();
+}
+
+void Reactor::wake() {
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        write(wakeFd, &one, sizeof(one));
+    }
+}
+
+void Reactor::runPosted() {
+    std::vector<Handler> ready;
+    {
+        std::lock_guard<std::mutex> lock(postedMutex);
+        ready.swap(posted);
+    }
+    for (Handler& handler : ready) handler();
+}
+
+void Reactor::run() {
+    running = true;
+    if (glibContext) {
+        runWithGLib();
+    } else {
+        runEpoll();
+    }
+}
+
+void Reactor::runEpoll() {
+    while (running) {
+        dispatchReady(-1); // Infinite wait, wake on any registered fd
+        if (afterDispatch) afterDispatch();
+    }
+}
+
+void Reactor::runWithGLib() {
+    // Own the context for the whole run so nested iterations (e.g. overlay
+    // settle waits) are recognised as happening on the GLib thread.
+    if (!g_main_context_acquire(glibContext)) {
+        LOG_ERROR("Reactor: GLib context is owned by another thread");
+        return;
+    }
+
+    while (running) {
+        gint maxPriority = 0;
+        g_main_context_prepare(glibContext, &maxPriority);
+
+        // Slot 0 is our epoll fd; GLib's own fds follow it.
+        gint timeoutMs = -1;
+        int glibCount = 0;
+        while (true) {
+            const int capacity = pollFds.empty() ? 0 : (int)pollFds.size() - 1;
+            glibCount = g_main_context_query(glibContext, maxPriority, &timeoutMs,
+                                             capacity > 0 ? pollFds.data() + 1 : nullptr, capacity);
+            if (glibCount <= capacity) break;
+            pollFds.resize(glibCount + 1);
+        }
+        if (pollFds.empty()) pollFds.resize(1);
+        pollFds[0].fd = epollFd;
+        pollFds[0].events = G_IO_IN;
+        for (int i = 0; i <= glibCount; ++i) pollFds[i].revents = 0;
+
+        if (poll(reinterpret_cast<struct pollfd*>(pollFds.data()), glibCount + 1, timeoutMs) < 0 && errno != EINTR) {
+            LOG_ERROR("Reactor: poll error: ", strerror(errno));
+            break;
+        }
+
+        if (g_main_context_check(glibContext, maxPriority, pollFds.data() + 1, glibCount)) {
+            g_main_context_dispatch(glibContext);
+        }
+        if (pollFds[0].revents & G_IO_IN) {
+            dispatchReady(0);
+        }
+        if (afterDispatch) afterDispatch();
+    }
+
+    g_main_context_release(glibContext);
+}
+
+void Reactor::dispatchReady(int timeoutMs) {
+    struct epoll_event events[MAX_EVENTS_PER_WAKEUP];
+    int n = epoll_wait(epollFd, events, MAX_EVENTS_PER_WAKEUP, timeoutMs);
+    if (n < 0) {
+        if (errno != EINTR) LOG_ERROR("Reactor: epoll_wait error: ", strerror(errno));
+        return;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        auto it = handlers.find(events[i].data.fd);
+        if (it == handlers.end()) continue; // Removed by an earlier handler
+        Handler handler = it->second;       // Copy: the handler may remove itself
+        handler();
+    }
+}
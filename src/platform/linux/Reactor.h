@@ -0,0 +1,60 @@
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <glib.h>
+
+// Single-threaded epoll reactor. Owns every fd the platform waits on and,
+// when attached, drives the GLib main context from the same poll, so all
+// Engine, Xlib and GTK work happens on the thread that calls run().
+class Reactor {
+public:
+    using Handler = std::function<void()>;
+
+    Reactor();
+    ~Reactor();
+
+    bool initialize();
+
+    // Calls `onReadable` on the reactor thread whenever `fd` is readable.
+    bool add(int fd, Handler onReadable);
+    void remove(int fd);
+
+    // Runs after every wakeup, e.g. to drain events a handler left queued in a library.
+    void setAfterDispatch(Handler hook) { afterDispatch = std::move(hook); }
+
+    // Acquire and iterate `context` as part of run().
+    void attachGLib(GMainContext* context) { glibContext = context; }
+
+    // Blocks dispatching handlers until stop() is called.
+    void run();
+
+    // Safe to call from any thread or from a handler.
+    void stop();
+
+    // Runs `handler` on the reactor thread at its next wakeup. Safe to call from any thread.
+    void post(Handler handler);
+
+private:
+    void runEpoll();
+    void runWithGLib();
+    void dispatchReady(int timeoutMs);
+    void wake();
+    void runPosted();
+
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::atomic<bool> running{false};
+    std::unordered_map<int, Handler> handlers;
+    Handler afterDispatch;
+    std::mutex postedMutex;
+    std::vector<Handler> posted;
+    GMainContext* glibContext = nullptr;
+    std::vector<GPollFD> pollFds;
+};
+
+#endif // REACTOR_H
@@ -10,43 +10,20 @@
 
 namespace {
 
-double clampValue(double value, double minValue, double maxValue) {
-    return std::max(minValue, std::min(value, maxValue));
-}
-
-Config::Rgba withAlpha(const Config::Rgba& color, double alpha) {
-    return {color.r, color.g, color.b, alpha};
-}
-
-Config::Rgba tileColorForIndex(int index) {
-    if (Config::PALETTE.empty()) return {0.0, 0.0, 0.0, 1.0};
-    return Config::PALETTE[index % Config::PALETTE.size()];
-}
-
-std::string labelForIndex(int index, int cols) {
-    if (cols == 6) {
-        if (index >= 0 && index < 26) {
-            char c = 'A' + index;
-            return std::string(1, c);
-        } else if (index >= 26 && index < 36) {
-            char c = '0' + (index - 26);
-            return std::string(1, c);
-        }
-    } else { // Assume 11x11
-        int r = index / cols;
-        int c = index % cols;
-        if (r < 11 && c < 11) {
-            char rowChar = 'A' + r;
-            char colChar = 'A' + c;
-            return std::string{rowChar, colChar};
-        }
-    }
-    return "";
+void queueDrawRect(GtkWidget* widget, const Rect& r) {
+    if (r.w <= 0.0 || r.h <= 0.0) return;
+    const int x0 = (int)std::floor(r.x);
+    const int y0 = (int)std::floor(r.y);
+    gtk_widget_queue_draw_area(widget, x0, y0,
+                               (int)std::ceil(r.x + r.w) - x0, (int)std::ceil(r.y + r.h) - y0);
 }
 
 } // namespace
 
-WaylandOverlay::WaylandOverlay() {}
+WaylandOverlay::WaylandOverlay()
+    : prerenderer([this](cairo_t* cr, const GridLayout& layout) {
+          prerenderRenderer.draw(cr, GridFrame{layout, false});
+      }) {}
 
 WaylandOverlay::~WaylandOverlay() {
     if (window) {
@@ -109,49 +86,97 @@ bool WaylandOverlay::initialize() {
 
     g_signal_connect(window, "draw", G_CALLBACK(WaylandOverlay::drawCallback), this);
     g_signal_connect(window, "configure-event", G_CALLBACK(WaylandOverlay::configureCallback), this);
+    gtk_widget_add_events(window, GDK_STRUCTURE_MASK);
+    g_signal_connect(window, "map-event", G_CALLBACK(WaylandOverlay::mapCallback), this);
 
     updateMonitorAndBoundsOnMainThread();
-    currentRect = bounds;
+    layout = GridLayout(bounds, 3, 3);
     initialized = true;
+
+    if (Config::OVERLAY_STANDBY) {
+        // Map once with an empty input region; show()/hide() then only
+        // change the content of the already-mapped surface.
+        cairo_region_t* empty = cairo_region_create();
+        gtk_widget_input_shape_combine_region(window, empty);
+        cairo_region_destroy(empty);
+        parked = true;
+        gtk_widget_show(window);
+        LOG_INFO("WaylandOverlay: Standby mode, overlay stays mapped while idle");
+    }
     return true;
 }
 
+// The reactor thread owns the GLib context, so every entry point below runs
+// on the GTK main thread and calls straight into it.
 void WaylandOverlay::show() {
-    g_idle_add(WaylandOverlay::idleShow, this);
+    geometrySettled = false;
+    showOnMainThread();
 }
 
 void WaylandOverlay::hide() {
-    g_idle_add(WaylandOverlay::idleHide, this);
+    hideConfirmed = false;
+    prerenderer.clear();
+    hideOnMainThread();
 }
 
-void WaylandOverlay::updateGrid(int rows, int cols, double x, double y, double w, double h, bool showPoint) {
-    {
-        std::lock_guard<std::mutex> lock(stateMutex);
-        gridRows = std::max(rows, 1);
-        gridCols = std::max(cols, 1);
-        showTargetPoint = showPoint;
-        currentRect = {x, y, w, h};
+void WaylandOverlay::prerender(const std::vector<GridLayout>& candidates) {
+    prerenderer.request(candidates);
+}
+
+void WaylandOverlay::updateGrid(const GridLayout& gridLayout, bool showPoint) {
+    // Updates between two frames collapse into one: the frame draws
+    // whatever layout is current by then.
+    layout = gridLayout;
+    showTargetPoint = showPoint;
+    if (frameScheduled) {
+        ++coalescedCount;
+        return;
     }
-    g_idle_add(WaylandOverlay::idleQueueDraw, this);
+    frameScheduled = true;
+    scheduleFrameOnMainThread();
 }
 
 bool WaylandOverlay::getBounds(Rect& out) {
-    std::lock_guard<std::mutex> lock(stateMutex);
     out = bounds;
     return out.w > 0.0 && out.h > 0.0;
 }
 
+bool WaylandOverlay::waitForSettledBounds(Rect& out, std::chrono::milliseconds timeout) {
+    const bool settled = waitOnMainLoop([this] { return geometrySettled; }, timeout);
+    out = bounds;
+    return settled;
+}
+
+bool WaylandOverlay::waitUntilHidden(std::chrono::milliseconds timeout) {
+    return waitOnMainLoop([this] { return hideConfirmed; }, timeout);
+}
+
+bool WaylandOverlay::waitOnMainLoop(const std::function<bool()>& done, std::chrono::milliseconds timeout) {
+    // Keep dispatching so the GDK events that complete the request can run,
+    // bounded by a one-shot timeout.
+    GMainContext* context = g_main_context_default();
+    bool timedOut = false;
+    guint timer = g_timeout_add((guint)timeout.count(), [](gpointer data) -> gboolean {
+        *static_cast<bool*>(data) = true;
+        return G_SOURCE_REMOVE;
+    }, &timedOut);
+    while (!timedOut && !done()) {
+        g_main_context_iteration(context, TRUE);
+    }
+    if (!timedOut) g_source_remove(timer);
+    return done();
+}
+
 void WaylandOverlay::setGlobalOrigin(int x, int y) {
-    std::lock_guard<std::mutex> lock(stateMutex);
     globalOriginX = x;
     globalOriginY = y;
     bounds.x = (double)x;
     bounds.y = (double)y;
 }
 
-void WaylandOverlay::updateMonitorAndBoundsOnMainThread() {
+bool WaylandOverlay::updateMonitorAndBoundsOnMainThread() {
     GdkDisplay* display = gdk_display_get_default();
-    if (!display || !window) return;
+    if (!display || !window) return false;
 
     GdkMonitor* monitor = nullptr;
 
@@ -173,220 +198,190 @@ void WaylandOverlay::updateMonitorAndBoundsOnMainThread() {
         monitor = gdk_display_get_monitor(display, 0);
     }
 
-    if (monitor) {
+    const bool monitorChanged = monitor != currentMonitor;
+    currentMonitor = monitor;
+    if (monitor && monitorChanged) {
         gtk_layer_set_monitor(GTK_WINDOW(window), monitor);
         GdkRectangle geometry;
         gdk_monitor_get_geometry(monitor, &geometry);
-        {
-            std::lock_guard<std::mutex> lock(stateMutex);
-            globalOriginX = geometry.x;
-            globalOriginY = geometry.y;
-        }
+        globalOriginX = geometry.x;
+        globalOriginY = geometry.y;
     }
 
     int w = gtk_widget_get_allocated_width(window);
     int h = gtk_widget_get_allocated_height(window);
     if (w > 0 && h > 0) {
-        std::lock_guard<std::mutex> lock(stateMutex);
         bounds.x = (double)globalOriginX;
         bounds.y = (double)globalOriginY;
         bounds.w = (double)w;
         bounds.h = (double)h;
     }
+    return monitorChanged;
 }
 
 void WaylandOverlay::showOnMainThread() {
     if (!initialized || !window) return;
-    updateMonitorAndBoundsOnMainThread();
+    const bool monitorChanged = updateMonitorAndBoundsOnMainThread();
     visible = true;
     gtk_widget_show(window);
-    gtk_widget_queue_draw(window);
+    if (parked) {
+        queueDrawOnMainThread();
+    } else {
+        lastDrawn = {0.0, 0.0, 0.0, 0.0}; // A fresh map draws the whole surface
+        gtk_widget_queue_draw(window);
+    }
+
+    // A parked surface on the same output gets no new configure or map event.
+    if (parked && !monitorChanged) markGeometrySettled(window);
 }
 
 void WaylandOverlay::hideOnMainThread() {
-    if (!window) return;
-    visible = false;
-    gtk_widget_hide(window);
+    if (window && frameTickId) {
+        gtk_widget_remove_tick_callback(window, frameTickId);
+        frameTickId = 0;
+    }
+    frameScheduled = false;
+    LOG_DEBUG("WaylandOverlay: ", framesQueued, " frames, ", coalescedCount, " coalesced updates, ",
+              droppedCount, " dropped frames");
+
+    if (window && parked) {
+        // Input passes through the empty input region; just draw nothing.
+        visible = false;
+        queueDrawRect(window, lastDrawn);
+    } else if (window) {
+        visible = false;
+        gtk_widget_hide(window);
+        // Round-trip so the compositor has processed the unmapping commit
+        // before anyone injects input at the surface's former location.
+        GdkDisplay* display = gdk_display_get_default();
+        if (display) gdk_display_sync(display);
+    }
+    hideConfirmed = true;
 }
 
 void WaylandOverlay::queueDrawOnMainThread() {
     if (!window || !visible) return;
-    gtk_widget_queue_draw(window);
-}
 
-gboolean WaylandOverlay::idleShow(gpointer data) {
-    static_cast<WaylandOverlay*>(data)->showOnMainThread();
-    return G_SOURCE_REMOVE;
+    // Invalidate only the previous frame's drawn area and the new one; GTK
+    // clips the draw callback to it and reports just that damage to the compositor.
+    const GridFrame frame{layout.translated(-bounds.x, -bounds.y), showTargetPoint};
+    queueDrawRect(window, unionRect(lastDrawn, GridRenderer::drawnExtent(frame)));
+    ++framesQueued;
 }
 
-gboolean WaylandOverlay::idleHide(gpointer data) {
-    static_cast<WaylandOverlay*>(data)->hideOnMainThread();
-    return G_SOURCE_REMOVE;
+// Waits for the next frame-clock tick, which GTK paces by wl_surface frame
+// callbacks, so at most one update is drawn per output refresh.
+void WaylandOverlay::scheduleFrameOnMainThread() {
+    GdkFrameClock* clock = window ? gtk_widget_get_frame_clock(window) : nullptr;
+    if (!clock || !visible || !gtk_widget_get_mapped(window)) {
+        // Nothing to pace against yet; mapping draws the whole surface.
+        frameScheduled = false;
+        queueDrawOnMainThread();
+        return;
+    }
+
+    frameRequestedAt = gdk_frame_clock_get_frame_counter(clock);
+    if (!frameTickId) frameTickId = gtk_widget_add_tick_callback(window, WaylandOverlay::frameTick, this, nullptr);
 }
 
-gboolean WaylandOverlay::idleQueueDraw(gpointer data) {
-    static_cast<WaylandOverlay*>(data)->queueDrawOnMainThread();
+gboolean WaylandOverlay::frameTick(GtkWidget* /*widget*/, GdkFrameClock* clock, gpointer data) {
+    auto* self = static_cast<WaylandOverlay*>(data);
+    self->frameTickId = 0;
+    self->frameScheduled = false; // Updates from here on need a frame of their own
+
+    // Refreshes that passed between the update and this tick.
+    const gint64 frame = gdk_frame_clock_get_frame_counter(clock);
+    if (self->frameRequestedAt >= 0 && frame - self->frameRequestedAt > 1) {
+        self->droppedCount += (int)(frame - self->frameRequestedAt - 1);
+    }
+    self->frameRequestedAt = -1;
+
+    // Invalidated during the update phase, so this frame's paint draws it.
+    self->queueDrawOnMainThread();
     return G_SOURCE_REMOVE;
 }
 
 gboolean WaylandOverlay::configureCallback(GtkWidget* widget, GdkEvent* /*event*/, gpointer data) {
-    auto* self = static_cast<WaylandOverlay*>(data);
+    static_cast<WaylandOverlay*>(data)->markGeometrySettled(widget);
+    return FALSE;
+}
+
+gboolean WaylandOverlay::mapCallback(GtkWidget* widget, GdkEvent* /*event*/, gpointer data) {
+    // The compositor may map with an unchanged size, in which case no new
+    // configure-event is emitted for this show().
+    static_cast<WaylandOverlay*>(data)->markGeometrySettled(widget);
+    return FALSE;
+}
+
+void WaylandOverlay::markGeometrySettled(GtkWidget* widget) {
     int w = gtk_widget_get_allocated_width(widget);
     int h = gtk_widget_get_allocated_height(widget);
-    if (w > 0 && h > 0) {
-        std::lock_guard<std::mutex> lock(self->stateMutex);
-        self->bounds.x = (double)self->globalOriginX;
-        self->bounds.y = (double)self->globalOriginY;
-        self->bounds.w = (double)w;
-        self->bounds.h = (double)h;
-    }
-    return FALSE;
+    if (w <= 0 || h <= 0) return;
+
+    bounds.x = (double)globalOriginX;
+    bounds.y = (double)globalOriginY;
+    bounds.w = (double)w;
+    bounds.h = (double)h;
+    if (visible) geometrySettled = true;
 }
 
 gboolean WaylandOverlay::drawCallback(GtkWidget* widget, cairo_t* cr, gpointer data) {
     auto* self = static_cast<WaylandOverlay*>(data);
 
-    Rect localBounds;
-    Rect localRect;
-    int rows = 3;
-    int cols = 3;
-    bool showPoint = false;
-
-    {
-        std::lock_guard<std::mutex> lock(self->stateMutex);
-        localBounds = self->bounds;
-        localRect = self->currentRect;
-        rows = self->gridRows;
-        cols = self->gridCols;
-        showPoint = self->showTargetPoint;
+    Rect localBounds = self->bounds;
+    const GridLayout& rootLayout = self->layout;
+    const bool showPoint = self->showTargetPoint;
+
+    if (!self->visible) {
+        // Parked in standby: keep the mapped surface fully transparent.
+        cairo_save(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_restore(cr);
+        self->lastDrawn = {0.0, 0.0, 0.0, 0.0};
+        return FALSE;
     }
 
     const int surfaceW = gtk_widget_get_allocated_width(widget);
     const int surfaceH = gtk_widget_get_allocated_height(widget);
-    if (surfaceW <= 0 || surfaceH <= 0 || rows <= 0 || cols <= 0) return FALSE;
+    if (surfaceW <= 0 || surfaceH <= 0 || rootLayout.empty()) return FALSE;
 
     if (localBounds.w <= 0.0 || localBounds.h <= 0.0) {
         localBounds.w = (double)surfaceW;
         localBounds.h = (double)surfaceH;
     }
 
-    Rect drawRect{
-        localRect.x - localBounds.x,
-        localRect.y - localBounds.y,
-        localRect.w,
-        localRect.h
-    };
-
-    drawRect.x = std::max(drawRect.x, -drawRect.w);
-    drawRect.y = std::max(drawRect.y, -drawRect.h);
-    drawRect.w = std::max(1.0, drawRect.w);
-    drawRect.h = std::max(1.0, drawRect.h);
-
-    if (std::abs(drawRect.x) <= 2.0) drawRect.x = 0.0;
-    if (std::abs(drawRect.y) <= 2.0) drawRect.y = 0.0;
-    if (std::abs((drawRect.x + drawRect.w) - surfaceW) <= 2.0) drawRect.w = std::max(1.0, (double)surfaceW - drawRect.x);
-    if (std::abs((drawRect.y + drawRect.h) - surfaceH) <= 2.0) drawRect.h = std::max(1.0, (double)surfaceH - drawRect.y);
-
-    const double surfaceArea = std::max(1.0, (double)surfaceW * (double)surfaceH);
-    const double drawArea = drawRect.w * drawRect.h;
-    const bool nearFullscreenArea = drawArea >= surfaceArea * 0.65;
-    const bool touchesLeftOrRight = drawRect.x <= 2.0 || (drawRect.x + drawRect.w) >= ((double)surfaceW - 2.0);
-    const bool touchesTopOrBottom = drawRect.y <= 2.0 || (drawRect.y + drawRect.h) >= ((double)surfaceH - 2.0);
-    if (nearFullscreenArea && (!touchesLeftOrRight || !touchesTopOrBottom)) {
-        drawRect = {0.0, 0.0, (double)surfaceW, (double)surfaceH};
+    GridFrame frame{rootLayout.translated(-localBounds.x, -localBounds.y), showPoint};
+    const bool corrected = GridRenderer::fitToSurface(frame.layout, surfaceW, surfaceH);
+
+    // GTK has already clipped `cr` to the invalidated area. If the rect was
+    // corrected to more than was invalidated, ask for the rest.
+    const Rect drawn = GridRenderer::drawnExtent(frame);
+    double clipX0 = 0.0, clipY0 = 0.0, clipX1 = 0.0, clipY1 = 0.0;
+    cairo_clip_extents(cr, &clipX0, &clipY0, &clipX1, &clipY1);
+    if (drawn.x < clipX0 || drawn.y < clipY0 || drawn.x + drawn.w > clipX1 || drawn.y + drawn.h > clipY1) {
+        queueDrawRect(widget, drawn);
     }
+    self->lastDrawn = drawn;
 
     cairo_save(cr);
     cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
     cairo_paint(cr);
     cairo_restore(cr);
 
-    cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
-    cairo_set_line_join(cr, CAIRO_LINE_JOIN_MITER);
-    cairo_set_line_cap(cr, CAIRO_LINE_CAP_SQUARE);
-
-    const double minCell = std::min(drawRect.w / cols, drawRect.h / rows);
-    double fontSizeMultiplier = (cols == 6) ? 0.35 : 0.25;
-    const double fontSize = clampValue(minCell * fontSizeMultiplier, 12.0, 72.0);
-    const double gridStroke = clampValue(minCell * 0.010, 1.0, 2.0);
-    const double borderStroke = clampValue(minCell * 0.012, 1.2, 2.4);
-
     cairo_save(cr);
     cairo_rectangle(cr, 0.0, 0.0, (double)surfaceW, (double)surfaceH);
     cairo_clip(cr);
 
-    if (!showPoint) {
-        for (int r = 0; r < rows; ++r) {
-            const double y0 = drawRect.y + (drawRect.h * r) / rows;
-            const double y1 = drawRect.y + (drawRect.h * (r + 1)) / rows;
-            for (int c = 0; c < cols; ++c) {
-                const double x0 = drawRect.x + (drawRect.w * c) / cols;
-                const double x1 = drawRect.x + (drawRect.w * (c + 1)) / cols;
-
-                const int index = r * cols + c;
-                const Config::Rgba fill = withAlpha(tileColorForIndex(index), Config::OVERLAY_FILL_ALPHA);
-
-                cairo_rectangle(cr, x0, y0, std::max(1.0, x1 - x0), std::max(1.0, y1 - y0));
-                cairo_set_source_rgba(cr, fill.r, fill.g, fill.b, fill.a);
-                cairo_fill(cr);
-            }
-        }
+    double patchX = 0.0;
+    double patchY = 0.0;
+    cairo_surface_t* patch = (!showPoint && !corrected) ? self->prerenderer.lookup(rootLayout, patchX, patchY) : nullptr;
+    if (patch) {
+        cairo_set_source_surface(cr, patch, patchX - localBounds.x, patchY - localBounds.y);
+        cairo_paint(cr);
+        cairo_surface_destroy(patch);
     } else {
-        const double cx = drawRect.x + drawRect.w / 2.0;
-        const double cy = drawRect.y + drawRect.h / 2.0;
-        const double radius = 4.0;
-
-        cairo_set_source_rgba(cr, 1.0, 0.0, 0.0, 0.8); // Red
-        cairo_arc(cr, cx, cy, radius, 0, 2 * M_PI);
-        cairo_fill(cr);
-        
-        cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 0.9); // White border
-        cairo_set_line_width(cr, 1.5);
-        cairo_arc(cr, cx, cy, radius, 0, 2 * M_PI);
-        cairo_stroke(cr);
-    }
-
-    if (!showPoint) {
-        cairo_set_source_rgba(cr, 0.92, 0.95, 1.0, 0.25);
-        cairo_set_line_width(cr, gridStroke);
-        for (int c = 1; c < cols; ++c) {
-            const double x = drawRect.x + (drawRect.w * c) / cols;
-            cairo_move_to(cr, x, drawRect.y);
-            cairo_line_to(cr, x, drawRect.y + drawRect.h);
-        }
-        for (int r = 1; r < rows; ++r) {
-            const double y = drawRect.y + (drawRect.h * r) / rows;
-            cairo_move_to(cr, drawRect.x, y);
-            cairo_line_to(cr, drawRect.x + drawRect.w, y);
-        }
-        cairo_stroke(cr);
-
-        cairo_set_source_rgba(cr, 0.96, 0.97, 1.0, 0.75);
-        cairo_set_line_width(cr, borderStroke);
-        cairo_rectangle(cr, drawRect.x, drawRect.y, drawRect.w, drawRect.h);
-        cairo_stroke(cr);
-
-        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-        cairo_set_font_size(cr, fontSize);
-        cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 1.0);
-
-        for (int r = 0; r < rows; ++r) {
-            const double y0 = drawRect.y + (drawRect.h * r) / rows;
-            const double y1 = drawRect.y + (drawRect.h * (r + 1)) / rows;
-            for (int c = 0; c < cols; ++c) {
-                const double x0 = drawRect.x + (drawRect.w * c) / cols;
-                const double x1 = drawRect.x + (drawRect.w * (c + 1)) / cols;
-                const std::string label = labelForIndex(r * cols + c, cols);
-
-                cairo_text_extents_t extents;
-                cairo_text_extents(cr, label.c_str(), &extents);
-
-                const double textX = x0 + ((x1 - x0) - extents.width) * 0.5 - extents.x_bearing;
-                const double textY = y0 + ((y1 - y0) - extents.height) * 0.5 - extents.y_bearing;
-                cairo_move_to(cr, textX, textY);
-                cairo_show_text(cr, label.c_str());
-            }
-        }
+        self->renderer.draw(cr, frame);
     }
 
     cairo_restore(cr);
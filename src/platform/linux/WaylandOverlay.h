@@ -3,9 +3,11 @@
 
 #include "../../core/Overlay.h"
 #include "../../core/Types.h"
+#include "FramePrerenderer.h"
+#include "../../render/GridRenderer.h"
 #include <gtk/gtk.h>
 #include <gtk-layer-shell.h>
-#include <mutex>
+#include <functional>
 
 class WaylandOverlay : public Overlay {
 public:
@@ -16,35 +18,62 @@ public:
 
     void show() override;
     void hide() override;
-    void updateGrid(int rows, int cols, double x, double y, double w, double h, bool showPoint = false) override;
+    void updateGrid(const GridLayout& layout, bool showPoint = false) override;
     bool getBounds(Rect& out) override;
+    void prerender(const std::vector<GridLayout>& candidates) override;
+    bool waitForSettledBounds(Rect& out, std::chrono::milliseconds timeout) override;
+    bool waitUntilHidden(std::chrono::milliseconds timeout) override;
     void setGlobalOrigin(int x, int y);
 
+    // Frame pacing counters: updates merged into an already scheduled frame,
+    // and output refreshes that passed between an update and its frame
+    int coalescedUpdates() const { return coalescedCount; }
+    int droppedFrames() const { return droppedCount; }
+
 private:
     static gboolean drawCallback(GtkWidget* widget, cairo_t* cr, gpointer data);
     static gboolean configureCallback(GtkWidget* widget, GdkEvent* event, gpointer data);
-    static gboolean idleShow(gpointer data);
-    static gboolean idleHide(gpointer data);
-    static gboolean idleQueueDraw(gpointer data);
+    static gboolean mapCallback(GtkWidget* widget, GdkEvent* event, gpointer data);
+    static gboolean frameTick(GtkWidget* widget, GdkFrameClock* clock, gpointer data);
 
     void showOnMainThread();
     void hideOnMainThread();
     void queueDrawOnMainThread();
-    void updateMonitorAndBoundsOnMainThread();
+    void scheduleFrameOnMainThread();
+    bool updateMonitorAndBoundsOnMainThread(); // Returns true if the output changed
+    void markGeometrySettled(GtkWidget* widget);
+    bool waitOnMainLoop(const std::function<bool()>& done, std::chrono::milliseconds timeout);
 
     GtkWidget* window = nullptr;
     bool initialized = false;
     bool visible = false;
+    bool parked = false; // Standby: surface stays mapped while idle
+    GdkMonitor* currentMonitor = nullptr;
+    Rect lastDrawn{0.0, 0.0, 0.0, 0.0}; // Window coordinates
+    guint frameTickId = 0;              // Pending frame-clock tick
+    gint64 frameRequestedAt = -1;       // Frame counter when that tick was requested
+    int framesQueued = 0;
+    int droppedCount = 0;
     int globalOriginX = 0;
     int globalOriginY = 0;
 
-    int gridRows = 3;
-    int gridCols = 3;
+    GridLayout layout; // Root coordinates, as sent by the engine
     bool showTargetPoint = false;
-    Rect currentRect{0.0, 0.0, 1.0, 1.0};
     Rect bounds{0.0, 0.0, 1.0, 1.0};
 
-    std::mutex stateMutex;
+    // Show/hide completion, polled by waitOnMainLoop
+    bool geometrySettled = false; // configure-event/map-event after show()
+    bool hideConfirmed = true;    // unmap round-trip finished after hide()
+
+    // A tick is on its way to draw the latest layout
+    bool frameScheduled = false;
+    int coalescedCount = 0;
+
+    // One renderer for the GTK main thread and one for the prerender worker
+    GridRenderer renderer;
+    GridRenderer prerenderRenderer;
+
+    FramePrerenderer prerenderer; // Thread-safe on its own
 };
 
 #endif // WAYLANDOVERLAY_H
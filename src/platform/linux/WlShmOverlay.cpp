@@ -0,0 +1,538 @@
+#include "WlShmOverlay.h"
+#include "../../core/Config.h"
+#include "../../core/Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+// How long acquiring a buffer waits for the compositor to release one.
+constexpr std::chrono::milliseconds RELEASE_TIMEOUT(50);
+
+} // namespace
+
+WlShmOverlay::WlShmOverlay()
+    : prerenderer([this](cairo_t* cr, const GridLayout& layout) {
+          prerenderRenderer.draw(cr, GridFrame{layout, false});
+      }) {}
+
+WlShmOverlay::~WlShmOverlay() {
+    prerenderer.clear();
+    destroyLayerSurface();
+    destroyBuffers();
+    if (hideSync) wl_callback_destroy(hideSync);
+    if (surface) wl_surface_destroy(surface);
+    for (auto& output : outputs) wl_output_destroy(output->output);
+    if (layerShell) zwlr_layer_shell_v1_destroy(layerShell);
+    if (shm) wl_shm_destroy(shm);
+    if (compositor) wl_compositor_destroy(compositor);
+    if (registry) wl_registry_destroy(registry);
+    if (display) {
+        wl_display_flush(display);
+        wl_display_disconnect(display);
+    }
+}
+
+bool WlShmOverlay::initialize() {
+    display = wl_display_connect(nullptr);
+    if (!display) {
+        LOG_ERROR("WlShmOverlay: Cannot connect to the Wayland display");
+        return false;
+    }
+
+    static const wl_registry_listener registryListener = {&WlShmOverlay::onGlobal, &WlShmOverlay::onGlobalRemove};
+    registry = wl_display_get_registry(display);
+    wl_registry_add_listener(registry, &registryListener, this);
+
+    // First round trip announces the globals, the second their initial state.
+    if (wl_display_roundtrip(display) < 0 || wl_display_roundtrip(display) < 0) {
+        LOG_ERROR("WlShmOverlay: Registry round trip failed");
+        return false;
+    }
+    if (!compositor || !shm) {
+        LOG_ERROR("WlShmOverlay: Compositor lacks wl_compositor or wl_shm");
+        return false;
+    }
+    if (!layerShell) {
+        LOG_ERROR("WlShmOverlay: Compositor does not support wlr-layer-shell");
+        return false;
+    }
+
+    createSurface();
+    wl_display_flush(display);
+
+    LOG_INFO("WlShmOverlay: Connected, ", outputs.size(), " output(s)");
+    return true;
+}
+
+int WlShmOverlay::fd() const {
+    return display ? wl_display_get_fd(display) : -1;
+}
+
+void WlShmOverlay::dispatch() {
+    if (!display) return;
+    if (wl_display_dispatch(display) < 0) connectionBroken();
+}
+
+void WlShmOverlay::flush() {
+    if (!display) return;
+    wl_display_dispatch_pending(display);
+    wl_display_flush(display);
+}
+
+bool WlShmOverlay::connectionBroken() {
+    const int error = display ? wl_display_get_error(display) : 0;
+    if (error == 0) return false;
+    LOG_ERROR("WlShmOverlay: Wayland connection error: ", strerror(error));
+    return true;
+}
+
+void WlShmOverlay::onGlobal(void* data, wl_registry* registry, uint32_t name, const char* interface,
+                            uint32_t version) {
+    WlShmOverlay* self = static_cast<WlShmOverlay*>(data);
+    if (std::strcmp(interface, wl_compositor_interface.name) == 0) {
+        self->compositorVersion = std::min(version, 4u);
+        self->compositor = static_cast<wl_compositor*>(
+            wl_registry_bind(registry, name, &wl_compositor_interface, self->compositorVersion));
+    } else if (std::strcmp(interface, wl_shm_interface.name) == 0) {
+        self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, name, &wl_shm_interface, 1));
+    } else if (std::strcmp(interface, zwlr_layer_shell_v1_interface.name) == 0) {
+        self->layerShell = static_cast<zwlr_layer_shell_v1*>(
+            wl_registry_bind(registry, name, &zwlr_layer_shell_v1_interface, std::min(version, 3u)));
+    } else if (std::strcmp(interface, wl_output_interface.name) == 0) {
+        static const wl_output_listener outputListener = {
+            &WlShmOverlay::onOutputGeometry, &WlShmOverlay::onOutputMode,
+            &WlShmOverlay::onOutputDone, &WlShmOverlay::onOutputScale,
+        };
+        auto output = std::make_unique<Output>();
+        output->name = name;
+        output->output = static_cast<wl_output*>(
+            wl_registry_bind(registry, name, &wl_output_interface, std::min(version, 2u)));
+        wl_output_add_listener(output->output, &outputListener, output.get());
+        self->outputs.push_back(std::move(output));
+    }
+}
+
+void WlShmOverlay::onGlobalRemove(void* data, wl_registry*, uint32_t name) {
+    WlShmOverlay* self = static_cast<WlShmOverlay*>(data);
+    for (auto it = self->outputs.begin(); it != self->outputs.end(); ++it) {
+        if ((*it)->name != name) continue;
+        if (self->currentOutput == it->get()) self->currentOutput = nullptr;
+        wl_output_destroy((*it)->output);
+        self->outputs.erase(it);
+        return;
+    }
+}
+
+void WlShmOverlay::onOutputGeometry(void* data, wl_output*, int32_t x, int32_t y, int32_t, int32_t, int32_t,
+                                    const char*, const char*, int32_t) {
+    Output* output = static_cast<Output*>(data);
+    output->x = x;
+    output->y = y;
+}
+
+void WlShmOverlay::onOutputMode(void* data, wl_output*, uint32_t flags, int32_t width, int32_t height, int32_t) {
+    if (!(flags & WL_OUTPUT_MODE_CURRENT)) return;
+    Output* output = static_cast<Output*>(data);
+    output->width = width;
+    output->height = height;
+}
+
+void WlShmOverlay::onOutputDone(void*, wl_output*) {}
+
+void WlShmOverlay::onOutputScale(void*, wl_output*, int32_t) {}
+
+// The origin comes from the output picked in createLayerSurface(); enter
+// only arrives after the first buffer, too late for the Engine's first grid.
+void WlShmOverlay::onSurfaceEnter(void*, wl_surface*, wl_output*) {}
+
+void WlShmOverlay::onSurfaceLeave(void*, wl_surface*, wl_output*) {}
+
+// A fresh wl_surface with its layer surface, committed without a buffer so
+// that the compositor configures it ahead of the first show().
+void WlShmOverlay::createSurface() {
+    static const wl_surface_listener surfaceListener = {&WlShmOverlay::onSurfaceEnter, &WlShmOverlay::onSurfaceLeave};
+    surface = wl_compositor_create_surface(compositor);
+    wl_surface_add_listener(surface, &surfaceListener, this);
+
+    // Pointer input always passes through, and nothing is opaque: the
+    // compositor keeps drawing what lies below every pixel.
+    wl_region* empty = wl_compositor_create_region(compositor);
+    wl_surface_set_input_region(surface, empty);
+    wl_surface_set_opaque_region(surface, empty);
+    wl_region_destroy(empty);
+
+    createLayerSurface();
+}
+
+void WlShmOverlay::createLayerSurface() {
+    static const zwlr_layer_surface_v1_listener layerListener = {&WlShmOverlay::onLayerConfigure,
+                                                                  &WlShmOverlay::onLayerClosed};
+    // Pin the surface to a known output, so the grid's origin is that
+    // output's position from the first configure on and never shifts under
+    // the Engine. The output stays the same until the compositor closes it.
+    if (!currentOutput && !outputs.empty()) currentOutput = outputs.front().get();
+    bounds.x = currentOutput ? currentOutput->x : 0.0;
+    bounds.y = currentOutput ? currentOutput->y : 0.0;
+    layerSurface = zwlr_layer_shell_v1_get_layer_surface(layerShell, surface,
+                                                         currentOutput ? currentOutput->output : nullptr,
+                                                         ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY, "keynav");
+    zwlr_layer_surface_v1_add_listener(layerSurface, &layerListener, this);
+    commitLayerState();
+}
+
+void WlShmOverlay::destroyLayerSurface() {
+    cancelFrame();
+    if (layerSurface) zwlr_layer_surface_v1_destroy(layerSurface);
+    layerSurface = nullptr;
+    configured = false;
+    mapped = false;
+}
+
+// Full-output, unmoved by exclusive zones, never focused. Unmapping resets
+// the layer surface, so this is sent again after every unmap.
+void WlShmOverlay::commitLayerState() {
+    zwlr_layer_surface_v1_set_anchor(layerSurface,
+                                     ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP | ZWLR_LAYER_SURFACE_V1_ANCHOR_BOTTOM |
+                                         ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT | ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT);
+    zwlr_layer_surface_v1_set_size(layerSurface, 0, 0);
+    zwlr_layer_surface_v1_set_exclusive_zone(layerSurface, -1);
+    zwlr_layer_surface_v1_set_keyboard_interactivity(layerSurface,
+                                                     ZWLR_LAYER_SURFACE_V1_KEYBOARD_INTERACTIVITY_NONE);
+    configured = false;
+    wl_surface_commit(surface);
+}
+
+void WlShmOverlay::onLayerConfigure(void* data, zwlr_layer_surface_v1* layerSurface, uint32_t serial,
+                                    uint32_t width, uint32_t height) {
+    WlShmOverlay* self = static_cast<WlShmOverlay*>(data);
+    zwlr_layer_surface_v1_ack_configure(layerSurface, serial);
+
+    if (width == 0 || height == 0) {
+        width = self->currentOutput ? self->currentOutput->width : 0;
+        height = self->currentOutput ? self->currentOutput->height : 0;
+    }
+    self->bounds.w = width;
+    self->bounds.h = height;
+    self->configured = true;
+
+    if ((int)width != self->bufferW || (int)height != self->bufferH) {
+        if (!self->createBuffers((int)width, (int)height)) return;
+        self->fullRedraw = true;
+    }
+    // Before the first frame after show(), updateGrid() maps the surface.
+    if (self->mapped) self->render();
+}
+
+void WlShmOverlay::onLayerClosed(void* data, zwlr_layer_surface_v1*) {
+    // The output went away; start over with a fresh surface.
+    WlShmOverlay* self = static_cast<WlShmOverlay*>(data);
+    LOG_WARN("WlShmOverlay: Layer surface closed by the compositor");
+    self->destroyLayerSurface();
+    wl_surface_destroy(self->surface);
+    self->bounds = {0.0, 0.0, 0.0, 0.0};
+    self->currentOutput = nullptr;
+    self->createSurface();
+}
+
+bool WlShmOverlay::createBuffers(int width, int height) {
+    destroyBuffers();
+    if (width <= 0 || height <= 0) return false;
+
+    const int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+    const size_t bufferSize = (size_t)stride * height;
+    poolSize = bufferSize * 2;
+
+    const int poolFd = memfd_create("keynav-overlay", MFD_CLOEXEC);
+    if (poolFd < 0 || ftruncate(poolFd, (off_t)poolSize) < 0) {
+        LOG_ERROR("WlShmOverlay: Cannot allocate ", poolSize, " bytes of shared memory: ", strerror(errno));
+        if (poolFd >= 0) close(poolFd);
+        poolSize = 0;
+        return false;
+    }
+    poolData = mmap(nullptr, poolSize, PROT_READ | PROT_WRITE, MAP_SHARED, poolFd, 0);
+    if (poolData == MAP_FAILED) {
+        LOG_ERROR("WlShmOverlay: mmap failed: ", strerror(errno));
+        close(poolFd);
+        poolData = nullptr;
+        poolSize = 0;
+        return false;
+    }
+
+    // WL_SHM_FORMAT_ARGB8888 is Cairo's ARGB32 on little-endian hosts.
+    static const wl_buffer_listener bufferListener = {&WlShmOverlay::onBufferRelease};
+    wl_shm_pool* pool = wl_shm_create_pool(shm, poolFd, (int32_t)poolSize);
+    for (int i = 0; i < 2; ++i) {
+        Buffer& buffer = buffers[i];
+        unsigned char* pixels = static_cast<unsigned char*>(poolData) + bufferSize * i;
+        buffer.buffer = wl_shm_pool_create_buffer(pool, (int32_t)(bufferSize * i), width, height, stride,
+                                                  WL_SHM_FORMAT_ARGB8888);
+        wl_buffer_add_listener(buffer.buffer, &bufferListener, &buffer);
+        buffer.surface = cairo_image_surface_create_for_data(pixels, CAIRO_FORMAT_ARGB32, width, height, stride);
+        buffer.cr = cairo_create(buffer.surface);
+        buffer.stale = {0.0, 0.0, (double)width, (double)height};
+        buffer.busy = false;
+    }
+    wl_shm_pool_destroy(pool);
+    close(poolFd);
+
+    bufferW = width;
+    bufferH = height;
+    LOG_DEBUG("WlShmOverlay: Created 2 buffers of ", width, "x", height);
+    return true;
+}
+
+void WlShmOverlay::destroyBuffers() {
+    for (Buffer& buffer : buffers) {
+        if (buffer.cr) cairo_destroy(buffer.cr);
+        if (buffer.surface) cairo_surface_destroy(buffer.surface);
+        if (buffer.buffer) wl_buffer_destroy(buffer.buffer);
+        buffer = Buffer();
+    }
+    if (poolData) munmap(poolData, poolSize);
+    poolData = nullptr;
+    poolSize = 0;
+    bufferW = 0;
+    bufferH = 0;
+}
+
+void WlShmOverlay::onBufferRelease(void* data, wl_buffer*) {
+    static_cast<Buffer*>(data)->busy = false;
+}
+
+// A buffer the compositor is not reading, preferring the one that lacks the
+// least. Waits for a release if both are attached.
+WlShmOverlay::Buffer* WlShmOverlay::acquireBuffer() {
+    auto pick = [this]() -> Buffer* {
+        Buffer* best = nullptr;
+        for (Buffer& buffer : buffers) {
+            if (!buffer.buffer || buffer.busy) continue;
+            if (!best || buffer.stale.w * buffer.stale.h < best->stale.w * best->stale.h) best = &buffer;
+        }
+        return best;
+    };
+
+    Buffer* buffer = pick();
+    if (buffer) return buffer;
+
+    ++stallCount;
+    pumpUntil([&]() { return (buffer = pick()) != nullptr; }, RELEASE_TIMEOUT);
+    if (!buffer) LOG_WARN("WlShmOverlay: No buffer released after ", RELEASE_TIMEOUT.count(), "ms, dropping frame");
+    return buffer;
+}
+
+void WlShmOverlay::show() {
+    isVisible = true;
+    hideConfirmed = false;
+    lastDrawn = {0.0, 0.0, 0.0, 0.0};
+    fullRedraw = true;
+    if (hideSync) {
+        wl_callback_destroy(hideSync);
+        hideSync = nullptr;
+    }
+
+    // The surface was configured while hidden, so the first updateGrid()
+    // maps it with a buffer. Nothing to draw until then.
+    if (!layerSurface) createSurface();
+    wl_display_flush(display);
+}
+
+void WlShmOverlay::hide() {
+    prerenderer.clear();
+    cancelFrame(); // An unmapped surface gets no more frame callbacks
+    const bool wasVisible = isVisible;
+    isVisible = false;
+    if (!mapped) {
+        hideConfirmed = true;
+        return;
+    }
+
+    // A null buffer unmaps the layer surface. Re-arm it right away with a
+    // buffer-less commit, so the configure for the next show() arrives while
+    // hidden. The sync callback fires once the compositor has processed both.
+    wl_surface_attach(surface, nullptr, 0, 0);
+    wl_surface_commit(surface);
+    mapped = false;
+    commitLayerState();
+    for (Buffer& buffer : buffers) {
+        buffer.stale = {0.0, 0.0, (double)bufferW, (double)bufferH};
+    }
+
+    static const wl_callback_listener syncListener = {&WlShmOverlay::onSyncDone};
+    if (hideSync) wl_callback_destroy(hideSync);
+    hideSync = wl_display_sync(display);
+    wl_callback_add_listener(hideSync, &syncListener, this);
+    hideConfirmed = !wasVisible;
+    wl_display_flush(display);
+    LOG_DEBUG("WlShmOverlay: Hidden after ", presentCount, " presents, ", coalescedCount, " coalesced updates, ",
+              stallCount, " buffer stalls");
+}
+
+void WlShmOverlay::onSyncDone(void* data, wl_callback* callback, uint32_t) {
+    WlShmOverlay* self = static_cast<WlShmOverlay*>(data);
+    wl_callback_destroy(callback);
+    if (self->hideSync == callback) self->hideSync = nullptr;
+    if (!self->isVisible) self->hideConfirmed = true;
+}
+
+void WlShmOverlay::prerender(const std::vector<GridLayout>& candidates) {
+    prerenderer.request(candidates);
+}
+
+void WlShmOverlay::updateGrid(const GridLayout& gridLayout, bool showPoint) {
+    layout = gridLayout;
+    showTargetPoint = showPoint;
+    if (!configured) return;
+
+    // One frame per output refresh: while the compositor has not asked for
+    // the next one, later updates only replace the layout it will draw.
+    if (frameCallback) {
+        if (renderPending) ++coalescedCount;
+        renderPending = true;
+        return;
+    }
+    render();
+}
+
+bool WlShmOverlay::waitForFrames(std::chrono::milliseconds timeout) {
+    return pumpUntil([this] { return !renderPending; }, timeout);
+}
+
+void WlShmOverlay::onFrameDone(void* data, wl_callback* callback, uint32_t) {
+    WlShmOverlay* self = static_cast<WlShmOverlay*>(data);
+    wl_callback_destroy(callback);
+    if (self->frameCallback == callback) self->frameCallback = nullptr;
+    if (self->renderPending) {
+        self->renderPending = false;
+        self->render();
+    }
+}
+
+void WlShmOverlay::cancelFrame() {
+    if (frameCallback) wl_callback_destroy(frameCallback);
+    frameCallback = nullptr;
+    renderPending = false;
+}
+
+bool WlShmOverlay::getBounds(Rect& out) {
+    if (bounds.w > 0.0 && bounds.h > 0.0) {
+        out = bounds;
+        return true;
+    }
+    const Output* output = currentOutput;
+    if (!output || output->width <= 0 || output->height <= 0) return false;
+    out = {(double)output->x, (double)output->y, (double)output->width, (double)output->height};
+    return true;
+}
+
+bool WlShmOverlay::waitForSettledBounds(Rect& out, std::chrono::milliseconds timeout) {
+    const bool settled = pumpUntil([this] { return configured; }, timeout);
+    getBounds(out);
+    return settled;
+}
+
+bool WlShmOverlay::waitUntilHidden(std::chrono::milliseconds timeout) {
+    return pumpUntil([this] { return hideConfirmed; }, timeout);
+}
+
+bool WlShmOverlay::pumpUntil(const std::function<bool()>& done, std::chrono::milliseconds timeout) {
+    if (!display) return done();
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    const int displayFd = wl_display_get_fd(display);
+
+    while (true) {
+        wl_display_dispatch_pending(display);
+        if (done()) return true;
+
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0 || connectionBroken()) return false;
+
+        // Standard read protocol: nobody else reads this display, but the
+        // queue must be empty before prepare_read() succeeds.
+        while (wl_display_prepare_read(display) != 0) wl_display_dispatch_pending(display);
+        wl_display_flush(display);
+
+        struct pollfd pfd;
+        pfd.fd = displayFd;
+        pfd.events = POLLIN;
+        const int ready = poll(&pfd, 1, (int)remaining.count() + 1);
+        if (ready > 0) {
+            wl_display_read_events(display);
+        } else {
+            wl_display_cancel_read(display);
+            if (ready < 0 && errno != EINTR) return false;
+        }
+    }
+}
+
+void WlShmOverlay::render() {
+    if (!isVisible || !configured || layout.empty() || bufferW <= 0) return;
+    if (!mapped) fullRedraw = true; // The compositor has no content yet
+
+    // Root coordinates to surface-local ones.
+    const GridFrame frame{layout.translated(-bounds.x, -bounds.y), showTargetPoint};
+    const Rect surfaceRect{0.0, 0.0, (double)bufferW, (double)bufferH};
+    const Rect drawn = intersectRect(GridRenderer::drawnExtent(frame), surfaceRect);
+    const Rect damage = fullRedraw ? surfaceRect : intersectRect(unionRect(lastDrawn, drawn), surfaceRect);
+    if (damage.w <= 0.0 || damage.h <= 0.0) return;
+
+    Buffer* buffer = acquireBuffer();
+    if (!buffer) return;
+    lastDrawn = drawn;
+    fullRedraw = false;
+
+    // The buffer may also lack what earlier frames drew into the other one.
+    const Rect paintArea = unionRect(damage, buffer->stale);
+    cairo_t* cr = buffer->cr;
+    cairo_save(cr);
+    cairo_rectangle(cr, paintArea.x, paintArea.y, paintArea.w, paintArea.h);
+    cairo_clip(cr);
+
+    cairo_save(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    double patchX = 0.0;
+    double patchY = 0.0;
+    cairo_surface_t* patch = showTargetPoint ? nullptr : prerenderer.lookup(layout, patchX, patchY);
+    if (patch) {
+        cairo_set_source_surface(cr, patch, patchX - bounds.x, patchY - bounds.y);
+        cairo_paint(cr);
+        cairo_surface_destroy(patch);
+    } else {
+        renderer.draw(cr, frame);
+    }
+    cairo_restore(cr);
+    cairo_surface_flush(buffer->surface);
+
+    static const wl_callback_listener frameListener = {&WlShmOverlay::onFrameDone};
+    if (frameCallback) wl_callback_destroy(frameCallback);
+    frameCallback = wl_surface_frame(surface);
+    wl_callback_add_listener(frameCallback, &frameListener, this);
+
+    wl_surface_attach(surface, buffer->buffer, 0, 0);
+    // Buffer and surface coordinates match at scale 1, so older compositors
+    // take the same rect through wl_surface.damage.
+    if (compositorVersion >= WL_SURFACE_DAMAGE_BUFFER_SINCE_VERSION) {
+        wl_surface_damage_buffer(surface, (int32_t)damage.x, (int32_t)damage.y, (int32_t)damage.w, (int32_t)damage.h);
+    } else {
+        wl_surface_damage(surface, (int32_t)damage.x, (int32_t)damage.y, (int32_t)damage.w, (int32_t)damage.h);
+    }
+    wl_surface_commit(surface);
+    wl_display_flush(display);
+
+    // This buffer now matches the surface; the other one lacks this frame.
+    buffer->busy = true;
+    buffer->stale = {0.0, 0.0, 0.0, 0.0};
+    Buffer& other = (buffer == &buffers[0]) ? buffers[1] : buffers[0];
+    other.stale = unionRect(other.stale, damage);
+    ++presentCount;
+    mapped = true;
+}
@@ -0,0 +1,142 @@
+#ifndef WLSHMOVERLAY_H
+#define WLSHMOVERLAY_H
+
+#include "../../core/Overlay.h"
+#include "../../core/Types.h"
+#include "FramePrerenderer.h"
+#include "../../render/GridRenderer.h"
+#include <cairo.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <wayland-client.h>
+#include "wlr-layer-shell-unstable-v1-client-protocol.h"
+
+// Wayland overlay that talks to wlr-layer-shell through libwayland-client
+// directly: one overlay-layer surface with an empty input region, drawn with
+// Cairo into two alternating wl_shm buffers and paced by frame callbacks.
+// Needs no GTK; the platform adds fd() to its reactor and calls dispatch()
+// when it is readable and flush() after every wakeup. All calls happen on
+// the reactor thread.
+class WlShmOverlay : public Overlay {
+public:
+    WlShmOverlay();
+    ~WlShmOverlay();
+
+    // False if there is no Wayland display or it lacks wl_shm or layer-shell
+    bool initialize();
+    int fd() const;
+    void dispatch();
+    void flush();
+
+    void show() override;
+    void hide() override;
+    void updateGrid(const GridLayout& layout, bool showPoint = false) override;
+    bool getBounds(Rect& out) override;
+    void prerender(const std::vector<GridLayout>& candidates) override;
+    bool waitForSettledBounds(Rect& out, std::chrono::milliseconds timeout) override;
+    bool waitUntilHidden(std::chrono::milliseconds timeout) override;
+
+    // Pumps events until no update is waiting for a frame callback
+    bool waitForFrames(std::chrono::milliseconds timeout);
+
+    int presents() const { return presentCount; }
+    int coalescedUpdates() const { return coalescedCount; }
+    int stalls() const { return stallCount; }
+
+private:
+    struct Output {
+        wl_output* output = nullptr;
+        uint32_t name = 0;
+        int x = 0; // Compositor-space position
+        int y = 0;
+        int width = 0; // Current mode
+        int height = 0;
+    };
+
+    struct Buffer {
+        wl_buffer* buffer = nullptr;
+        cairo_surface_t* surface = nullptr;
+        cairo_t* cr = nullptr;
+        Rect stale{0.0, 0.0, 0.0, 0.0}; // Differs from the surface's current content
+        bool busy = false;              // Attached; wl_buffer.release not yet received
+    };
+
+    static void onGlobal(void* data, wl_registry* registry, uint32_t name, const char* interface, uint32_t version);
+    static void onGlobalRemove(void* data, wl_registry* registry, uint32_t name);
+    static void onOutputGeometry(void* data, wl_output* output, int32_t x, int32_t y, int32_t physicalWidth,
+                                 int32_t physicalHeight, int32_t subpixel, const char* make, const char* model,
+                                 int32_t transform);
+    static void onOutputMode(void* data, wl_output* output, uint32_t flags, int32_t width, int32_t height,
+                             int32_t refresh);
+    static void onOutputDone(void* data, wl_output* output);
+    static void onOutputScale(void* data, wl_output* output, int32_t factor);
+    static void onSurfaceEnter(void* data, wl_surface* surface, wl_output* output);
+    static void onSurfaceLeave(void* data, wl_surface* surface, wl_output* output);
+    static void onLayerConfigure(void* data, zwlr_layer_surface_v1* layerSurface, uint32_t serial,
+                                 uint32_t width, uint32_t height);
+    static void onLayerClosed(void* data, zwlr_layer_surface_v1* layerSurface);
+    static void onBufferRelease(void* data, wl_buffer* buffer);
+    static void onSyncDone(void* data, wl_callback* callback, uint32_t time);
+    static void onFrameDone(void* data, wl_callback* callback, uint32_t time);
+
+    void createSurface();
+    void createLayerSurface();
+    void destroyLayerSurface();
+    void commitLayerState();
+    bool createBuffers(int width, int height);
+    void destroyBuffers();
+    Buffer* acquireBuffer();
+    void render();
+    void cancelFrame();
+
+    // Reads and dispatches events until `done` or the timeout; false on timeout
+    bool pumpUntil(const std::function<bool()>& done, std::chrono::milliseconds timeout);
+    bool connectionBroken();
+
+    wl_display* display = nullptr;
+    wl_registry* registry = nullptr;
+    wl_compositor* compositor = nullptr;
+    uint32_t compositorVersion = 0; // Bound version; damage_buffer needs 4
+    wl_shm* shm = nullptr;
+    zwlr_layer_shell_v1* layerShell = nullptr;
+    std::vector<std::unique_ptr<Output>> outputs;
+    Output* currentOutput = nullptr; // The layer surface is pinned here
+
+    wl_surface* surface = nullptr;
+    zwlr_layer_surface_v1* layerSurface = nullptr;
+    wl_callback* hideSync = nullptr;
+    wl_callback* frameCallback = nullptr; // Requested with the last commit
+    bool renderPending = false;           // An update waits for that callback
+
+    // Shared-memory pool holding both buffers
+    void* poolData = nullptr;
+    size_t poolSize = 0;
+    Buffer buffers[2];
+    int bufferW = 0;
+    int bufferH = 0;
+
+    GridLayout layout; // Root coordinates, as sent by the engine
+    bool showTargetPoint = false;
+    Rect bounds{0.0, 0.0, 0.0, 0.0}; // currentOutput's position, configured size
+    Rect lastDrawn{0.0, 0.0, 0.0, 0.0};
+    bool fullRedraw = true;
+
+    bool isVisible = false;
+    bool configured = false;   // Configure acked since the layer surface was (re)armed
+    bool mapped = false;       // A buffer is committed
+    bool hideConfirmed = true; // Compositor processed the unmap commit
+
+    int presentCount = 0;
+    int coalescedCount = 0;
+    int stallCount = 0;
+
+    // One renderer for the reactor thread and one for the prerender worker
+    GridRenderer renderer;
+    GridRenderer prerenderRenderer;
+
+    FramePrerenderer prerenderer;
+};
+
+#endif // WLSHMOVERLAY_H
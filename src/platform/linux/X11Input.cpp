@@ -4,7 +4,7 @@
 #include <iostream>
 #include "../../core/Logger.h"
 
-X11Input::X11Input(Display* d, Engine* e) : display(d), engine(e) {}
+X11Input::X11Input(Display* d, Engine* e) : display(d), engine(e), keymap(Keymap::current()) {}
 
 X11Input::~X11Input() {
     if (keyboardGrabbed) ungrabKeyboard();
@@ -69,6 +69,29 @@ void X11Input::ungrabKeyboard() {
     // LOG_INFO("Keyboard ungrabbed.");
 }
 
+bool X11Input::waitUntilUngrabbed(std::chrono::milliseconds /*timeout*/) {
+    // XSync returns once the server has processed the XUngrabKeyboard request.
+    XSync(display, False);
+    return !keyboardGrabbed;
+}
+
+// X11 events arrive on the reactor thread, so they reach the Engine directly,
+// through the same dispatch() entry point (and trace tap) as queued evdev events.
+void X11Input::dispatch(EngineEventType type, char c, bool shift) {
+    EngineEvent event;
+    event.type = type;
+    event.c = c;
+    event.shift = shift;
+    engine->dispatch(event);
+}
+
+void X11Input::dispatchAction(KeyAction action, EngineEventType type) {
+    EngineEvent event;
+    event.type = type;
+    event.action = action;
+    engine->dispatch(event);
+}
+
 void X11Input::handleEvent(XEvent& event) {
     if (event.type != KeyPress && event.type != KeyRelease) return;
     
@@ -93,33 +116,16 @@ void X11Input::handleEvent(XEvent& event) {
             }
         }
 
+        const KeyBinding& binding = keymap.keysym(key);
         if (pressed) {
-            if (key == XK_Escape) {
-                engine->onDeactivate();
-            } else if (key == XK_BackSpace) {
-                engine->onControlKey("backspace");
-            } else if (key == XK_Return) {
-                engine->onControlKey("enter");
-            } else if (key == XK_space) {
-                engine->onControlKey("space");
-            } else if (key == XK_f) {
-                engine->onClick(1, 1, false); // Left click, STAY
-            } else if (key >= XK_a && key <= XK_z) {
-                bool shift = (event.xkey.state & ShiftMask) != 0;
-                engine->onChar('a' + (key - XK_a), shift);
-            } else if (key >= XK_A && key <= XK_Z) {
-                engine->onChar('a' + (key - XK_A), true);
-            } else if (key >= XK_0 && key <= XK_9) {
-                engine->onChar('0' + (key - XK_0), false);
+            if (binding.action != KeyAction::Unbound) dispatchAction(binding.action);
+            if (binding.c != '\0') {
+                bool shift = (event.xkey.state & ShiftMask) != 0 || (key >= XK_A && key <= XK_Z);
+                dispatch(EngineEventType::Char, binding.c, shift);
             }
         } else if (released && !isAutoRepeat) {
-            if (key >= XK_a && key <= XK_z) {
-                engine->onKeyRelease('a' + (key - XK_a));
-            } else if (key >= XK_A && key <= XK_Z) {
-                engine->onKeyRelease('a' + (key - XK_A));
-            } else if (key >= XK_0 && key <= XK_9) {
-                engine->onKeyRelease('0' + (key - XK_0));
-            }
+            if (isDirection(binding.action)) dispatchAction(binding.action, EngineEventType::ActionRelease);
+            if (binding.c != '\0') dispatch(EngineEventType::CharRelease, binding.c);
         }
         // Swallow other keys
     } 
@@ -130,7 +136,7 @@ void X11Input::handleEvent(XEvent& event) {
         // The event loop in Platform needs to route it here.
         if (event.xkey.keycode == activationKeyCode) {
             // Check modifiers (ignoring Lock/Mod2 noise is handled by grab, but check just in case)
-             engine->onActivate();
+             dispatch(EngineEventType::Activate);
         }
     }
 }
@@ -2,6 +2,8 @@
 #define X11INPUT_H
 
 #include "../../core/Input.h"
+#include "../../core/EngineEvent.h"
+#include "../../core/Keymap.h"
 #include <X11/Xlib.h>
 
 class Engine; // Forward decl
@@ -14,15 +16,19 @@ public:
     bool initialize(int screenW = 0, int screenH = 0) override;
     void grabKeyboard() override;
     void ungrabKeyboard() override;
+    bool waitUntilUngrabbed(std::chrono::milliseconds timeout) override;
 
     // Handle X11 KeyPress/KeyRelease
     void handleEvent(XEvent& event);
 
 private:
     void grabActivationKey();
+    void dispatch(EngineEventType type, char c = '\0', bool shift = false);
+    void dispatchAction(KeyAction action, EngineEventType type = EngineEventType::Action);
     
     Display* display;
     Engine* engine;
+    const Keymap& keymap;
     bool keyboardGrabbed = false;
     
     // Configurable Activation Key (Phase 2: Alt+G)
@@ -3,47 +3,23 @@
 #include <iostream>
 #include "../../core/Logger.h"
 #include <algorithm>
+#include <cerrno>
 #include <cstring>
 #include <cstdlib>
 #include <array>
 #include <cmath>
+#include <functional>
 #include <X11/extensions/Xrandr.h>
+#include <X11/extensions/shape.h>
+#include <poll.h>
 
 namespace {
 
-double clampValue(double value, double minValue, double maxValue) {
-    return std::max(minValue, std::min(value, maxValue));
-}
-
-Config::Rgba withAlpha(const Config::Rgba& color, double alpha) {
-    return {color.r, color.g, color.b, alpha};
-}
+// How many times show() re-requests geometry when the compositor insets the window.
+constexpr int MAX_GEOMETRY_CORRECTIONS = 5;
 
-Config::Rgba tileColorForIndex(int index) {
-    if (Config::PALETTE.empty()) return {0.0, 0.0, 0.0, 1.0};
-    return Config::PALETTE[index % Config::PALETTE.size()];
-}
-
-std::string labelForIndex(int index, int cols) {
-    if (cols == 6) {
-        if (index >= 0 && index < 26) {
-            char c = 'A' + index;
-            return std::string(1, c);
-        } else if (index >= 26 && index < 36) {
-            char c = '0' + (index - 26);
-            return std::string(1, c);
-        }
-    } else { // Assume 11x11
-        int r = index / cols;
-        int c = index % cols;
-        if (r < 11 && c < 11) {
-            char rowChar = 'A' + r;
-            char colChar = 'A' + c;
-            return std::string{rowChar, colChar};
-        }
-    }
-    return "";
-}
+// Slack around the drawn area kept inside the window shape.
+constexpr double SHAPE_MARGIN = 4.0;
 
 bool queryActiveMonitorRect(Display* display, int screen, Rect& out) {
     if (!display) return false;
@@ -95,7 +71,11 @@ bool queryActiveMonitorRect(Display* display, int screen, Rect& out) {
 
 } // namespace
 
-X11Overlay::X11Overlay(Display* d, int s) : display(d), screen(s) {}
+X11Overlay::X11Overlay(Display* d, int s)
+    : display(d), screen(s), shm(d, s),
+      prerenderer([this](cairo_t* cr, const GridLayout& layout) {
+          prerenderRenderer.draw(cr, GridFrame{layout, false});
+      }) {}
 
 X11Overlay::~X11Overlay() {
     destroyWindow();
@@ -103,9 +83,32 @@ X11Overlay::~X11Overlay() {
 
 bool X11Overlay::initialize() {
     createWindow();
+    if (window && Config::OVERLAY_STANDBY) park();
     return true;
 }
 
+// Standby: map the window once, transparent and with an empty input region,
+// and leave it mapped; show()/hide() then only change its content.
+void X11Overlay::park() {
+    if (!shapeSupported) {
+        LOG_WARN("X11Overlay: SHAPE extension missing, standby mode disabled");
+        return;
+    }
+    XShapeCombineRectangles(display, window, ShapeInput, 0, 0, nullptr, 0, ShapeSet, Unsorted);
+
+    monitorRect = {0.0, 0.0, (double)DisplayWidth(display, screen), (double)DisplayHeight(display, screen)};
+    if (!runningOnWayland) {
+        queryActiveMonitorRect(display, screen, monitorRect);
+    }
+    requestRect = monitorRect;
+    XMoveResizeWindow(display, window, (int)requestRect.x, (int)requestRect.y,
+                      (unsigned int)requestRect.w, (unsigned int)requestRect.h);
+    XMapRaised(display, window);
+    XFlush(display);
+    parked = true;
+    LOG_INFO("X11Overlay: Standby mode, overlay stays mapped while idle");
+}
+
 void X11Overlay::createWindow() {
     const char* sessionType = std::getenv("XDG_SESSION_TYPE");
     const char* waylandDisplay = std::getenv("WAYLAND_DISPLAY");
@@ -189,18 +192,34 @@ void X11Overlay::createWindow() {
     // Only listen for Expose events. Input is handled globally now.
     XSelectInput(display, window, ExposureMask | StructureNotifyMask);
 
+    int shapeEventBase = 0;
+    int shapeErrorBase = 0;
+    shapeSupported = XShapeQueryExtension(display, &shapeEventBase, &shapeErrorBase);
+    if (!shapeSupported) {
+        LOG_WARN("X11Overlay: SHAPE extension missing, overlay window keeps its full monitor shape");
+    }
+
     surface = cairo_xlib_surface_create(display, window, vinfo.visual, screenW, screenH);
     cr = cairo_create(surface);
     surfaceW = screenW;
     surfaceH = screenH;
+    visual = vinfo.visual;
+    visualDepth = vinfo.depth;
+
+    if (Config::OVERLAY_SHM) {
+        if (shm.resize(window, visual, visualDepth, surfaceW, surfaceH)) {
+            LOG_INFO("X11Overlay: Rendering into MIT-SHM buffers");
+        } else {
+            LOG_INFO("X11Overlay: MIT-SHM unavailable, drawing through Xlib");
+        }
+    }
 
-    // Initial rect
-    currentRect = monitorRect;
+    // Initial grid until the engine sends one
+    layout = GridLayout(monitorRect, 3, 3);
 }
 
 void X11Overlay::destroyWindow() {
-    std::lock_guard<std::mutex> lock(overlayMutex);
-
+    shm.release();
     if (cr) cairo_destroy(cr);
     if (surface) cairo_surface_destroy(surface);
     if (window) XDestroyWindow(display, window);
@@ -209,100 +228,98 @@ void X11Overlay::destroyWindow() {
     window = 0;
     surfaceW = 0;
     surfaceH = 0;
+    shapeApplied = false;
 }
 
 void X11Overlay::show() {
-    std::lock_guard<std::mutex> lock(overlayMutex);
-
     isVisible = true;
     
-    // Force-reposition before and after mapping.
-    Rect monitorRect{0.0, 0.0, (double)DisplayWidth(display, screen), (double)DisplayHeight(display, screen)};
+    monitorRect = {0.0, 0.0, (double)DisplayWidth(display, screen), (double)DisplayHeight(display, screen)};
     if (!runningOnWayland) {
         queryActiveMonitorRect(display, screen, monitorRect);
     }
-    int screenX = (int)monitorRect.x;
-    int screenY = (int)monitorRect.y;
-    int screenW = (int)monitorRect.w;
-    int screenH = (int)monitorRect.h;
-    int requestX = screenX;
-    int requestY = screenY;
-    int requestW = screenW;
-    int requestH = screenH;
-    XMoveResizeWindow(display, window, requestX, requestY, requestW, requestH);
-
-    XMapRaised(display, window);
-
-    // Some WMs/Xwayland setups apply geometry asynchronously.
-    // Iteratively overscan if the compositor insets/shrinks this window.
-    for (int i = 0; i < 5; ++i) {
-        XSync(display, False);
-        XMoveResizeWindow(display, window, requestX, requestY, requestW, requestH);
-        XRaiseWindow(display, window);
-        XSync(display, False);
-
-        XWindowAttributes attrs;
-        Window child = 0;
-        int actualX = 0;
-        int actualY = 0;
-        int actualW = 0;
-        int actualH = 0;
-        if (!XGetWindowAttributes(display, window, &attrs)) continue;
-        actualW = attrs.width;
-        actualH = attrs.height;
-        if (!XTranslateCoordinates(display, window, RootWindow(display, screen), 0, 0, &actualX, &actualY, &child)) {
-            continue;
-        }
-
-        const int gapL = actualX - screenX;
-        const int gapT = actualY - screenY;
-        const int gapR = (screenX + screenW) - (actualX + actualW);
-        const int gapB = (screenY + screenH) - (actualY + actualH);
-
-        if (std::abs(gapL) <= 1 && std::abs(gapT) <= 1 &&
-            std::abs(gapR) <= 1 && std::abs(gapB) <= 1) {
-            break;
+    geometryCorrections = 0;
+    unmapConfirmed = false;
+
+    if (parked) {
+        // Already mapped: on the same monitor the last settled geometry still
+        // holds, otherwise move and evaluate what the server reports.
+        if (standbySettled && sameRect(monitorRect, standbyMonitor)) {
+            geometrySettled = true;
+            XRaiseWindow(display, window);
+            XFlush(display);
+            return;
         }
+        geometrySettled = false;
+        requestRect = monitorRect;
+        XMoveResizeWindow(display, window, (int)requestRect.x, (int)requestRect.y,
+                          (unsigned int)requestRect.w, (unsigned int)requestRect.h);
+        XRaiseWindow(display, window);
+        Rect actual;
+        if (getBounds(actual)) evaluateGeometry(actual);
+        XFlush(display);
+        return;
+    }
 
-        // Expand request only where compositor is leaving positive gaps.
-        if (gapL > 0) {
-            requestX -= gapL;
-            requestW += gapL;
-        }
-        if (gapT > 0) {
-            requestY -= gapT;
-            requestH += gapT;
-        }
-        if (gapR > 0) requestW += gapR;
-        if (gapB > 0) requestH += gapB;
+    requestRect = monitorRect;
+    geometrySettled = false;
+    lastDrawn = {0.0, 0.0, 0.0, 0.0}; // Mapping starts from the cleared background
+    resetShape();
 
-        requestW = std::max(requestW, screenW);
-        requestH = std::max(requestH, screenH);
-    }
+    // Geometry is confirmed by the MapNotify/ConfigureNotify that follow;
+    // see evaluateGeometry() for the overscan correction.
+    XMoveResizeWindow(display, window, (int)requestRect.x, (int)requestRect.y,
+                      (unsigned int)requestRect.w, (unsigned int)requestRect.h);
+    XMapRaised(display, window);
     XFlush(display);
 }
 
 void X11Overlay::hide() {
-    std::lock_guard<std::mutex> lock(overlayMutex);
+    prerenderer.clear();
+    if (shm.active()) {
+        LOG_DEBUG("X11Overlay: Hiding after ", shm.presents(), " SHM presents, ", shm.stalls(),
+                  " waits for a back buffer");
+    }
 
+    if (parked) {
+        // Input already passes through the empty input region; clearing the
+        // content is all that hiding takes.
+        isVisible = false;
+        unmapConfirmed = true;
+        if (cr && lastDrawn.w > 0.0 && lastDrawn.h > 0.0) {
+            cairo_save(cr);
+            cairo_rectangle(cr, lastDrawn.x, lastDrawn.y, lastDrawn.w, lastDrawn.h);
+            cairo_clip(cr);
+            cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+            cairo_paint(cr);
+            cairo_restore(cr);
+            cairo_surface_flush(surface);
+            shm.invalidate(lastDrawn);
+        }
+        lastDrawn = {0.0, 0.0, 0.0, 0.0};
+        applyShape(lastDrawn); // Nothing left for the compositor to blend
+        XFlush(display);
+        return;
+    }
+
+    // Nothing to confirm if the window is not mapped; no UnmapNotify would follow.
+    unmapConfirmed = !isVisible;
     isVisible = false;
     XUnmapWindow(display, window);
     XFlush(display);
 }
 
-void X11Overlay::updateGrid(int rows, int cols, double x, double y, double w, double h, bool showPoint) {
-    std::lock_guard<std::mutex> lock(overlayMutex);
+void X11Overlay::prerender(const std::vector<GridLayout>& candidates) {
+    prerenderer.request(candidates);
+}
 
-    gridRows = rows;
-    gridCols = cols;
+void X11Overlay::updateGrid(const GridLayout& gridLayout, bool showPoint) {
+    layout = gridLayout;
     showTargetPoint = showPoint;
-    currentRect = {x, y, w, h};
-    renderLocked();
+    render();
 }
 
 bool X11Overlay::getBounds(Rect& out) {
-    std::lock_guard<std::mutex> lock(overlayMutex);
-
     if (!window) return false;
 
     XWindowAttributes attrs;
@@ -319,18 +336,155 @@ bool X11Overlay::getBounds(Rect& out) {
     return true;
 }
 
-void X11Overlay::handleExpose() {
-    std::lock_guard<std::mutex> lock(overlayMutex);
-    if (isVisible) renderLocked();
+bool X11Overlay::waitForSettledBounds(Rect& out, std::chrono::milliseconds timeout) {
+    if (waitForStructure([this] { return geometrySettled; }, timeout)) {
+        out = settledBounds;
+        return true;
+    }
+    getBounds(out);
+    return false;
 }
 
-void X11Overlay::render() {
-    std::lock_guard<std::mutex> lock(overlayMutex);
-    renderLocked();
+bool X11Overlay::waitUntilHidden(std::chrono::milliseconds timeout) {
+    return waitForStructure([this] { return unmapConfirmed; }, timeout);
+}
+
+bool X11Overlay::waitForStructure(const std::function<bool()>& done, std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    const int x11Fd = ConnectionNumber(display);
+
+    while (true) {
+        // Pull our own structure events; the platform loop is blocked on us.
+        XEvent event;
+        while (!done() && window &&
+               XCheckWindowEvent(display, window, StructureNotifyMask, &event)) {
+            handleStructureEvent(event);
+        }
+        if (done()) return true;
+
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) return false;
+
+        struct pollfd pfd;
+        pfd.fd = x11Fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, (int)remaining.count() + 1) < 0 && errno != EINTR) return false;
+    }
+}
+
+void X11Overlay::handleStructureEvent(const XEvent& event) {
+    if (event.type == UnmapNotify && event.xunmap.window == window) {
+        if (!isVisible) unmapConfirmed = true;
+        return;
+    }
+
+    if (!isVisible || geometrySettled) return;
+
+    if (event.type == ConfigureNotify && event.xconfigure.window == window) {
+        // Override-redirect windows are not reparented, so these are root coordinates.
+        evaluateGeometry({(double)event.xconfigure.x, (double)event.xconfigure.y,
+                          (double)event.xconfigure.width, (double)event.xconfigure.height});
+    } else if (event.type == MapNotify && event.xmap.window == window) {
+        // The geometry may be unchanged since the last show(), in which case
+        // no ConfigureNotify follows; evaluate what the server has now.
+        Rect actual;
+        if (getBounds(actual)) evaluateGeometry(actual);
+    }
+}
+
+void X11Overlay::evaluateGeometry(const Rect& actual) {
+    const int gapL = (int)(actual.x - monitorRect.x);
+    const int gapT = (int)(actual.y - monitorRect.y);
+    const int gapR = (int)((monitorRect.x + monitorRect.w) - (actual.x + actual.w));
+    const int gapB = (int)((monitorRect.y + monitorRect.h) - (actual.y + actual.h));
+
+    const bool covers = std::abs(gapL) <= 1 && std::abs(gapT) <= 1 &&
+                        std::abs(gapR) <= 1 && std::abs(gapB) <= 1;
+    if (covers || geometryCorrections >= MAX_GEOMETRY_CORRECTIONS) {
+        settledBounds = actual;
+        geometrySettled = true;
+        if (parked) {
+            standbyMonitor = monitorRect;
+            standbySettled = true;
+        }
+        return;
+    }
+
+    // Some WMs/Xwayland setups inset or shrink the window asynchronously.
+    // Expand the request only where the compositor is leaving positive gaps.
+    if (gapL > 0) {
+        requestRect.x -= gapL;
+        requestRect.w += gapL;
+    }
+    if (gapT > 0) {
+        requestRect.y -= gapT;
+        requestRect.h += gapT;
+    }
+    if (gapR > 0) requestRect.w += gapR;
+    if (gapB > 0) requestRect.h += gapB;
+
+    requestRect.w = std::max(requestRect.w, monitorRect.w);
+    requestRect.h = std::max(requestRect.h, monitorRect.h);
+
+    ++geometryCorrections;
+    XMoveResizeWindow(display, window, (int)requestRect.x, (int)requestRect.y,
+                      (unsigned int)requestRect.w, (unsigned int)requestRect.h);
+    XRaiseWindow(display, window);
+    XFlush(display);
+}
+
+// Clip the bounding shape, and outside standby the input shape, to the drawn
+// area plus a margin. The compositor then blends only that part of the
+// window, and clicks elsewhere reach the windows below. An empty `drawn`
+// empties both shapes.
+void X11Overlay::applyShape(const Rect& drawn) {
+    if (!shapeSupported || !window) return;
+
+    Rect region{0.0, 0.0, 0.0, 0.0};
+    if (drawn.w > 0.0 && drawn.h > 0.0) {
+        const Rect padded{drawn.x - SHAPE_MARGIN, drawn.y - SHAPE_MARGIN,
+                          drawn.w + 2 * SHAPE_MARGIN, drawn.h + 2 * SHAPE_MARGIN};
+        region = intersectRect(padded, {0.0, 0.0, (double)surfaceW, (double)surfaceH});
+    }
+    if (shapeApplied && sameRect(region, shapeRect)) return;
+
+    XRectangle rect;
+    rect.x = (short)region.x;
+    rect.y = (short)region.y;
+    rect.width = (unsigned short)region.w;
+    rect.height = (unsigned short)region.h;
+    const int count = (region.w > 0.0 && region.h > 0.0) ? 1 : 0;
+
+    XShapeCombineRectangles(display, window, ShapeBounding, 0, 0, &rect, count, ShapeSet, YXBanded);
+    if (!parked) {
+        // Standby keeps its empty input region.
+        XShapeCombineRectangles(display, window, ShapeInput, 0, 0, &rect, count, ShapeSet, YXBanded);
+    }
+    shapeRect = region;
+    shapeApplied = true;
 }
 
-void X11Overlay::renderLocked() {
-    if (!isVisible || !cr || gridRows <= 0 || gridCols <= 0) return;
+// Restore the default shapes, i.e. the whole window.
+void X11Overlay::resetShape() {
+    if (!shapeSupported || !window || !shapeApplied) return;
+
+    XShapeCombineMask(display, window, ShapeBounding, 0, 0, None, ShapeSet);
+    if (!parked) XShapeCombineMask(display, window, ShapeInput, 0, 0, None, ShapeSet);
+    shapeApplied = false;
+}
+
+bool X11Overlay::handleShmEvent(const XEvent& event) {
+    return shm.handleEvent(event);
+}
+
+void X11Overlay::handleExpose() {
+    fullRedraw = true;
+    if (isVisible) render();
+}
+
+void X11Overlay::render() {
+    if (!isVisible || !cr || layout.empty()) return;
 
     // Ensure the Cairo surface matches the window size
     XWindowAttributes attrs;
@@ -342,10 +496,15 @@ void X11Overlay::renderLocked() {
             cr = cairo_create(surface);
             surfaceW = attrs.width;
             surfaceH = attrs.height;
+            fullRedraw = true;
         } else if (attrs.width != surfaceW || attrs.height != surfaceH) {
             cairo_xlib_surface_set_size(surface, attrs.width, attrs.height);
             surfaceW = attrs.width;
             surfaceH = attrs.height;
+            fullRedraw = true;
+            if (shm.active() && !shm.resize(window, visual, visualDepth, surfaceW, surfaceH)) {
+                LOG_WARN("X11Overlay: MIT-SHM resize failed, drawing through Xlib");
+            }
         }
     }
 
@@ -359,142 +518,49 @@ void X11Overlay::renderLocked() {
     }
 
     // Convert from root coordinates to this window's local coordinates.
-    Rect drawRect{
-        currentRect.x - windowRect.x,
-        currentRect.y - windowRect.y,
-        currentRect.w,
-        currentRect.h
-    };
-
-    // Keep draw rect within sane values to avoid rendering artifacts.
-    drawRect.x = std::max(drawRect.x, -drawRect.w);
-    drawRect.y = std::max(drawRect.y, -drawRect.h);
-    drawRect.w = std::max(1.0, drawRect.w);
-    drawRect.h = std::max(1.0, drawRect.h);
-
-    // Snap near-fullscreen rects to exact pixel bounds to avoid visible margins.
-    if (std::abs(drawRect.x) <= 2.0) drawRect.x = 0.0;
-    if (std::abs(drawRect.y) <= 2.0) drawRect.y = 0.0;
-    if (std::abs((drawRect.x + drawRect.w) - surfaceW) <= 2.0) drawRect.w = std::max(1.0, (double)surfaceW - drawRect.x);
-    if (std::abs((drawRect.y + drawRect.h) - surfaceH) <= 2.0) drawRect.h = std::max(1.0, (double)surfaceH - drawRect.y);
-
-    // Guard against transient inset geometries captured during activation.
-    // If the rect is still "mostly fullscreen" but detached from surface edges,
-    // force a full-surface draw to avoid corner gaps.
-    const double surfaceArea = std::max(1.0, (double)surfaceW * (double)surfaceH);
-    const double drawArea = drawRect.w * drawRect.h;
-    const bool nearFullscreenArea = drawArea >= surfaceArea * 0.65;
-    const bool touchesLeftOrRight = drawRect.x <= 2.0 || (drawRect.x + drawRect.w) >= ((double)surfaceW - 2.0);
-    const bool touchesTopOrBottom = drawRect.y <= 2.0 || (drawRect.y + drawRect.h) >= ((double)surfaceH - 2.0);
-    if (nearFullscreenArea && (!touchesLeftOrRight || !touchesTopOrBottom)) {
-        drawRect = {0.0, 0.0, (double)surfaceW, (double)surfaceH};
-    }
+    GridFrame frame{layout.translated(-windowRect.x, -windowRect.y), showTargetPoint};
+    const bool corrected = GridRenderer::fitToSurface(frame.layout, surfaceW, surfaceH);
+
+    // Repaint only what changed: the previous frame's drawn area and this one's.
+    const Rect surfaceRect{0.0, 0.0, (double)surfaceW, (double)surfaceH};
+    const Rect drawn = intersectRect(GridRenderer::drawnExtent(frame), surfaceRect);
+    const Rect damage = fullRedraw ? surfaceRect : intersectRect(unionRect(lastDrawn, drawn), surfaceRect);
+    lastDrawn = drawn;
+    fullRedraw = false;
+    applyShape(drawn);
+    if (damage.w <= 0.0 || damage.h <= 0.0) return;
+    LOG_DEBUG("X11Overlay: Repainting ", damage.w, "x", damage.h, " of ", surfaceW, "x", surfaceH);
+
+    // With MIT-SHM, draw into the back buffer, which may also lack older frames.
+    Rect paintArea = damage;
+    cairo_t* target = shm.active() ? shm.beginFrame(paintArea) : cr;
+
+    cairo_save(target);
+    cairo_rectangle(target, paintArea.x, paintArea.y, paintArea.w, paintArea.h);
+    cairo_clip(target);
 
     // Clear background
-    cairo_save(cr);
-    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
-    cairo_paint(cr);
-    cairo_restore(cr);
-
-    // Rectangular production layout: edge-to-edge cells, no spacing.
-    cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
-    cairo_set_line_join(cr, CAIRO_LINE_JOIN_MITER);
-    cairo_set_line_cap(cr, CAIRO_LINE_CAP_SQUARE);
-
-    const double minCell = std::min(drawRect.w / gridCols, drawRect.h / gridRows);
-    double fontSizeMultiplier = (gridCols == 6) ? 0.35 : 0.25;
-    const double fontSize = clampValue(minCell * fontSizeMultiplier, 12.0, 72.0);
-    const double gridStroke = clampValue(minCell * 0.010, 1.0, 2.0);
-    const double borderStroke = clampValue(minCell * 0.012, 1.2, 2.4);
-
-    // Clip drawing to visible surface bounds for robustness.
-    cairo_save(cr);
-    cairo_rectangle(cr, 0.0, 0.0, (double)surfaceW, (double)surfaceH);
-    cairo_clip(cr);
-
-    // Draw contiguous translucent cells (no gap).
-    if (!showTargetPoint) {
-        for (int r = 0; r < gridRows; ++r) {
-            const double y0 = drawRect.y + (drawRect.h * r) / gridRows;
-            const double y1 = drawRect.y + (drawRect.h * (r + 1)) / gridRows;
-            for (int c = 0; c < gridCols; ++c) {
-                const double x0 = drawRect.x + (drawRect.w * c) / gridCols;
-                const double x1 = drawRect.x + (drawRect.w * (c + 1)) / gridCols;
-
-                const int index = r * gridCols + c;
-                const Config::Rgba fill = withAlpha(tileColorForIndex(index), Config::OVERLAY_FILL_ALPHA);
-
-                cairo_rectangle(cr, x0, y0, std::max(1.0, x1 - x0), std::max(1.0, y1 - y0));
-                cairo_set_source_rgba(cr, fill.r, fill.g, fill.b, fill.a);
-                cairo_fill(cr);
-            }
-        }
+    cairo_save(target);
+    cairo_set_operator(target, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(target);
+    cairo_restore(target);
+
+    // A prerendered candidate only needs a blit.
+    double patchX = 0.0;
+    double patchY = 0.0;
+    cairo_surface_t* patch = (!showTargetPoint && !corrected) ? prerenderer.lookup(layout, patchX, patchY) : nullptr;
+    if (patch) {
+        cairo_set_source_surface(target, patch, patchX - windowRect.x, patchY - windowRect.y);
+        cairo_paint(target);
+        cairo_surface_destroy(patch);
     } else {
-        // Draw a small high-visibility target point at the center
-        const double cx = drawRect.x + drawRect.w / 2.0;
-        const double cy = drawRect.y + drawRect.h / 2.0;
-        const double radius = 4.0;
-
-        cairo_set_source_rgba(cr, 1.0, 0.0, 0.0, 0.8); // Red point
-        cairo_arc(cr, cx, cy, radius, 0, 2 * M_PI);
-        cairo_fill(cr);
-        
-        cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 0.9); // White border
-        cairo_set_line_width(cr, 1.5);
-        cairo_arc(cr, cx, cy, radius, 0, 2 * M_PI);
-        cairo_stroke(cr);
-    }
-
-    // Grid dividers.
-    if (!showTargetPoint) {
-        cairo_set_source_rgba(cr, 0.92, 0.95, 1.0, 0.25);
-        cairo_set_line_width(cr, gridStroke);
-        for (int c = 1; c < gridCols; ++c) {
-            const double x = drawRect.x + (drawRect.w * c) / gridCols;
-            cairo_move_to(cr, x, drawRect.y);
-            cairo_line_to(cr, x, drawRect.y + drawRect.h);
-        }
-        for (int r = 1; r < gridRows; ++r) {
-            const double y = drawRect.y + (drawRect.h * r) / gridRows;
-            cairo_move_to(cr, drawRect.x, y);
-            cairo_line_to(cr, drawRect.x + drawRect.w, y);
-        }
-        cairo_stroke(cr);
+        renderer.draw(target, frame);
     }
 
-    // Outer border end-to-end.
-    if (!showTargetPoint) {
-        cairo_set_source_rgba(cr, 0.96, 0.97, 1.0, 0.75);
-        cairo_set_line_width(cr, borderStroke);
-        cairo_rectangle(cr, drawRect.x, drawRect.y, drawRect.w, drawRect.h);
-        cairo_stroke(cr);
-    }
-
-    // Key labels (smaller, readable).
-    if (!showTargetPoint) {
-        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-        cairo_set_font_size(cr, fontSize);
-        cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 1.0);
-
-        for (int r = 0; r < gridRows; ++r) {
-            const double y0 = drawRect.y + (drawRect.h * r) / gridRows;
-            const double y1 = drawRect.y + (drawRect.h * (r + 1)) / gridRows;
-            for (int c = 0; c < gridCols; ++c) {
-                const double x0 = drawRect.x + (drawRect.w * c) / gridCols;
-                const double x1 = drawRect.x + (drawRect.w * (c + 1)) / gridCols;
-                const std::string label = labelForIndex(r * gridCols + c, gridCols);
-
-                cairo_text_extents_t extents;
-                cairo_text_extents(cr, label.c_str(), &extents);
-
-                const double textX = x0 + ((x1 - x0) - extents.width) * 0.5 - extents.x_bearing;
-                const double textY = y0 + ((y1 - y0) - extents.height) * 0.5 - extents.y_bearing;
-                cairo_move_to(cr, textX, textY);
-                cairo_show_text(cr, label.c_str());
-            }
-        }
+    cairo_restore(target);
+    if (shm.active()) {
+        shm.present(damage);
+    } else {
+        cairo_surface_flush(surface);
     }
-
-    cairo_restore(cr);
-    cairo_surface_flush(surface);
 }
@@ -3,6 +3,9 @@
 
 #include "../../core/Overlay.h"
 #include "../../core/Types.h"
+#include "FramePrerenderer.h"
+#include "../../render/GridRenderer.h"
+#include "X11ShmBuffers.h"
 #include <string>
 #include <vector>
 #include <X11/Xlib.h>
@@ -10,7 +13,7 @@
 #include <X11/Xatom.h>
 #include <cairo.h>
 #include <cairo-xlib.h>
-#include <mutex>
+#include <functional>
 
 class X11Overlay : public Overlay {
 public:
@@ -20,19 +23,32 @@ public:
     bool initialize();
     void show() override;
     void hide() override;
-    void updateGrid(int rows, int cols, double x, double y, double w, double h, bool showPoint = false) override;
+    void updateGrid(const GridLayout& layout, bool showPoint = false) override;
     bool getBounds(Rect& out) override;
+    void prerender(const std::vector<GridLayout>& candidates) override;
+    bool waitForSettledBounds(Rect& out, std::chrono::milliseconds timeout) override;
+    bool waitUntilHidden(std::chrono::milliseconds timeout) override;
 
     Window getWindow() const { return window; }
 
     // Handle X11 Expose events from the platform loop
     void handleExpose();
 
+    // Handle Map/Unmap/Configure notifications for the overlay window from the platform loop
+    void handleStructureEvent(const XEvent& event);
+
+    // Handle MIT-SHM completion events from the platform loop; true if consumed
+    bool handleShmEvent(const XEvent& event);
+
 private:
     void createWindow();
+    void park();
     void destroyWindow();
     void render();
-    void renderLocked();
+    void applyShape(const Rect& drawn);
+    void resetShape();
+    void evaluateGeometry(const Rect& actual);
+    bool waitForStructure(const std::function<bool()>& done, std::chrono::milliseconds timeout);
 
     Display* display;
     int screen;
@@ -43,16 +59,46 @@ private:
     cairo_t* cr = nullptr;
     int surfaceW = 0;
     int surfaceH = 0;
+    Visual* visual = nullptr;
+    int visualDepth = 0;
+
+    // Client-side rendering; inactive when MIT-SHM is off or unavailable
+    X11ShmBuffers shm;
+
+    // Damage tracking: area covered by the last frame, in window coordinates
+    Rect lastDrawn{0.0, 0.0, 0.0, 0.0};
+    bool fullRedraw = true;
+
+    // Window shape clipped to the drawn area, in window coordinates
+    bool shapeSupported = false;
+    bool shapeApplied = false; // False while the default (whole window) shapes are in place
+    Rect shapeRect{0.0, 0.0, 0.0, 0.0};
     
     // Grid state
-    int gridRows = 3;
-    int gridCols = 3;
+    GridLayout layout; // Root coordinates, as sent by the engine
     bool showTargetPoint = false;
-    Rect currentRect;
     bool runningOnWayland = false;
     
-    bool isVisible = false;
-    std::mutex overlayMutex;
+    bool isVisible = false; // All calls happen on the platform's reactor thread
+
+    // Map/unmap confirmation tracking for the current show()/hide() cycle
+    Rect monitorRect{0.0, 0.0, 0.0, 0.0};
+    Rect requestRect{0.0, 0.0, 0.0, 0.0};
+    Rect settledBounds{0.0, 0.0, 0.0, 0.0};
+    bool geometrySettled = false;
+    int geometryCorrections = 0;
+    bool unmapConfirmed = true;
+
+    // Standby mode: window stays mapped between activations
+    bool parked = false;
+    bool standbySettled = false;
+    Rect standbyMonitor{0.0, 0.0, 0.0, 0.0};
+
+    // One renderer for the reactor thread and one for the prerender worker
+    GridRenderer renderer;
+    GridRenderer prerenderRenderer;
+
+    FramePrerenderer prerenderer;
 };
 
 #endif // X11OVERLAY_H
@@ -1,11 +1,14 @@
 #include "X11Platform.h"
 #include "X11Overlay.h"
 #include "WaylandOverlay.h"
+#include "WlShmOverlay.h"
 #include "X11Input.h"
 #include "EvdevInput.h"
 #include "../../core/Logger.h"
+#include "../../core/Config.h"
 #include <iostream>
-#include <poll.h>
+#include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <cstdlib>
 #include <string>
@@ -14,6 +17,7 @@
 #include <X11/extensions/Xrandr.h>
 #include <X11/keysym.h>
 #include <sys/signalfd.h>
+#include <sys/timerfd.h>
 #include <signal.h>
 #include <unistd.h>
 
@@ -24,10 +28,12 @@ int x11ErrorHandler(Display* d, XErrorEvent* e) {
     return 0;
 }
 
-X11Platform::X11Platform(Engine* e, bool evdev) : engine(e), useEvdev(evdev) {}
+X11Platform::X11Platform(Engine* e, bool evdev)
+    : engine(e), useEvdev(evdev), glide([this](int x, int y) { sendCursor(x, y); }) {}
 
 X11Platform::~X11Platform() {
     if (sigFd >= 0) close(sigFd);
+    if (frameTimerFd >= 0) close(frameTimerFd);
     if (display) XCloseDisplay(display);
 }
 
@@ -63,7 +69,7 @@ void X11Platform::processSignal() {
 }
 
 bool X11Platform::initialize() {
-    XInitThreads();
+    // No XInitThreads(): all Xlib calls happen on the reactor thread.
     XSetErrorHandler(x11ErrorHandler);
 
     display = XOpenDisplay(NULL);
@@ -74,13 +80,38 @@ bool X11Platform::initialize() {
     screen = DefaultScreen(display);
 
     setupSignalHandling();
+    if (!reactor.initialize() || !eventQueue.initialize()) {
+        LOG_ERROR("X11Platform: Failed to set up the event loop");
+        return false;
+    }
+    injector.initialize();
+    frameInterval = refreshInterval();
+    frameTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (frameTimerFd < 0) {
+        LOG_ERROR("X11Platform: Frame timer unavailable, precision motion disabled: ", strerror(errno));
+    }
+    if (Config::CURSOR_GLIDE && glide.initialize()) {
+        glide.setDuration(Config::CURSOR_GLIDE_DURATION);
+        glide.setFrameInterval(frameInterval);
+    }
 
     const char* sessionType = std::getenv("XDG_SESSION_TYPE");
     const char* waylandDisplay = std::getenv("WAYLAND_DISPLAY");
     const bool runningOnWayland = (waylandDisplay && waylandDisplay[0] != '\0') ||
                                   (sessionType && std::string(sessionType) == "wayland");
 
-    if (useEvdev && runningOnWayland) {
+    if (useEvdev && runningOnWayland && Config::WAYLAND_OVERLAY == "shm") {
+        wlShmOverlay = std::make_unique<WlShmOverlay>();
+        if (wlShmOverlay->initialize()) {
+            overlay = wlShmOverlay.get();
+            LOG_INFO("Using Native Wayland wl_shm Layer-Shell Overlay");
+        } else {
+            wlShmOverlay.reset();
+            LOG_WARN("wl_shm overlay initialization failed, falling back to the GTK layer-shell overlay.");
+        }
+    }
+
+    if (useEvdev && runningOnWayland && !overlay) {
         waylandOverlay = std::make_unique<WaylandOverlay>();
 
         if (waylandOverlay->initialize()) {
@@ -103,7 +134,7 @@ bool X11Platform::initialize() {
 
     if (useEvdev) {
         LOG_INFO("Using Evdev Input Backend (Requires sudo/uinput)");
-        input = std::make_unique<EvdevInput>(engine);
+        input = std::make_unique<EvdevInput>(&eventQueue);
     } else {
         LOG_INFO("Using X11 Input Backend");
         input = std::make_unique<X11Input>(display, engine);
@@ -132,6 +163,12 @@ void X11Platform::processX11Events() {
         if (event.type == Expose && x11Overlay) {
             x11Overlay->handleExpose();
         } 
+        else if ((event.type == ConfigureNotify || event.type == MapNotify || event.type == UnmapNotify) && x11Overlay) {
+            x11Overlay->handleStructureEvent(event);
+        } 
+        else if (x11Overlay && x11Overlay->handleShmEvent(event)) {
+            // Overlay frame presented; its buffer is free again
+        }
         else if (event.type == KeyPress || event.type == KeyRelease) {
             if (!useEvdev) {
                 static_cast<X11Input*>(input.get())->handleEvent(event);
@@ -146,67 +183,56 @@ void X11Platform::run() {
     std::string activationKey = useEvdev ? "Alt+G or RIGHT CTRL" : "Alt+G";
     LOG_INFO("KeyNav Platform Running (", activationKey, " to Activate)...");
 
-    int x11Fd = ConnectionNumber(display);
+    // Every fd lives on this one reactor thread: the X connection, signals,
+    // decoded evdev events, the injection timer and, for the Wayland overlays,
+    // the GLib context or the Wayland connection. Engine, Xlib, GTK and
+    // libwayland calls therefore never cross threads.
+    reactor.add(ConnectionNumber(display), [this]() { processX11Events(); });
+    reactor.add(sigFd, [this]() {
+        processSignal();
+        if (!isRunning) reactor.stop();
+    });
+    reactor.add(eventQueue.fd(), [this]() {
+        eventQueue.drain([this](const EngineEvent& event) { engine->dispatch(event); });
+    });
+    reactor.add(injector.fd(), [this]() { injector.dispatch(); });
+    if (glide.fd() >= 0) {
+        reactor.add(glide.fd(), [this]() { glide.dispatch(); });
+    }
+    if (frameTimerFd >= 0) {
+        reactor.add(frameTimerFd, [this]() {
+            uint64_t expirations = 0;
+            while (read(frameTimerFd, &expirations, sizeof(expirations)) > 0) {}
+            engine->onFrame(std::chrono::steady_clock::now());
+        });
+    }
 
-    if (usingWaylandOverlay) {
-        // Integrate X11 events into GLib main loop
-        GIOChannel* x11Channel = g_io_channel_unix_new(x11Fd);
-        g_io_add_watch(x11Channel, G_IO_IN, [](GIOChannel*, GIOCondition, gpointer data) -> gboolean {
-            auto* platform = static_cast<X11Platform*>(data);
-            platform->processX11Events();
-            return G_SOURCE_CONTINUE;
-        }, this);
-        g_io_channel_unref(x11Channel);
-
-        // Integrate Signals into GLib main loop
-        if (sigFd >= 0) {
-            GIOChannel* sigChannel = g_io_channel_unix_new(sigFd);
-            g_io_add_watch(sigChannel, G_IO_IN, [](GIOChannel*, GIOCondition, gpointer data) -> gboolean {
-                auto* platform = static_cast<X11Platform*>(data);
-                platform->processSignal();
-                if (!platform->isRunning) g_main_context_wakeup(nullptr);
-                return G_SOURCE_CONTINUE;
-            }, this);
-            g_io_channel_unref(sigChannel);
-        }
+    // Handlers (e.g. overlay waits, XSync) can pull X events into Xlib's
+    // queue without leaving the socket readable; never leave them behind.
+    reactor.setAfterDispatch([this]() {
+        if (XEventsQueued(display, QueuedAlready) > 0) processX11Events();
+        if (wlShmOverlay) wlShmOverlay->flush();
+    });
 
-        while (isRunning) {
-            g_main_context_iteration(nullptr, true); // True = Blocking wait
-        }
-    } else {
-        // Native Poll loop for X11 without GLib
-        while (isRunning) {
-            struct pollfd pfds[2];
-            pfds[0].fd = x11Fd;
-            pfds[0].events = POLLIN;
-            
-            pfds[1].fd = sigFd;
-            pfds[1].events = POLLIN;
-
-            int ret = poll(pfds, 2, -1); // Infinite wait (-1), wake on input or signal!
-            if (ret < 0) {
-                if (errno != EINTR) LOG_ERROR("X11Platform: poll error: ", strerror(errno));
-                break; 
-            }
+    if (wlShmOverlay) {
+        reactor.add(wlShmOverlay->fd(), [this]() { wlShmOverlay->dispatch(); });
+    }
 
-            if (pfds[0].revents & POLLIN) {
-                processX11Events();
-            }
-            if (sigFd >= 0 && (pfds[1].revents & POLLIN)) {
-                processSignal();
-            }
-        }
+    if (usingWaylandOverlay) {
+        reactor.attachGLib(g_main_context_default());
     }
 
+    if (isRunning) reactor.run();
+
     LOG_INFO("X11Platform: Run loop exiting...");
+    glide.finish();
+    injector.flush(); // Never leave a button pressed
     releaseModifiers();
 }
 
 void X11Platform::exit() {
     isRunning = false;
-    if (usingWaylandOverlay) {
-        g_main_context_wakeup(nullptr);
-    }
+    reactor.stop();
 }
 
 void X11Platform::getScreenSize(int& w, int& h) {
@@ -219,7 +245,7 @@ void X11Platform::getScreenSize(int& w, int& h) {
         }
     }
 
-    if (!usingWaylandOverlay) {
+    if (!usingWaylandOverlay && !wlShmOverlay) {
         Window root = RootWindow(display, screen);
         int monitorCount = 0;
         XRRMonitorInfo* monitors = XRRGetMonitors(display, root, True, &monitorCount);
@@ -257,15 +283,98 @@ void X11Platform::getScreenSize(int& w, int& h) {
     h = DisplayHeight(display, screen);
 }
 
+void X11Platform::moveCursor(int x, int y) {
+    if (!Config::CURSOR_GLIDE || glide.fd() < 0) {
+        sendCursor(x, y);
+        return;
+    }
+
+    // A running glide turns from where it is; a new one starts at the pointer.
+    int fromX = x, fromY = y;
+    if (!glide.active()) {
+        int winX = 0, winY = 0;
+        unsigned int mask = 0;
+        Window rootReturn = 0, childReturn = 0;
+        XQueryPointer(display, RootWindow(display, screen), &rootReturn, &childReturn,
+                      &fromX, &fromY, &winX, &winY, &mask);
+    }
+    glide.glideTo(fromX, fromY, x, y);
+}
+
+void X11Platform::warpCursor(int x, int y) {
+    glide.finish();
+    sendCursor(x, y);
+}
+
+void X11Platform::setFrameTicks(bool enabled) {
+    if (frameTimerFd < 0) return;
+
+    // Periodic from the first tick; the Engine measures elapsed time itself,
+    // so a late tick is never followed by a burst of catch-up frames.
+    struct itimerspec spec;
+    std::memset(&spec, 0, sizeof(spec));
+    if (enabled) {
+        const int64_t ns = frameInterval.count();
+        spec.it_interval.tv_sec = (time_t)(ns / 1000000000LL);
+        spec.it_interval.tv_nsec = (long)(ns % 1000000000LL);
+        spec.it_value = spec.it_interval;
+    }
+    if (timerfd_settime(frameTimerFd, 0, &spec, nullptr) < 0) {
+        LOG_ERROR("X11Platform: timerfd_settime failed: ", strerror(errno));
+    }
+}
+
+void X11Platform::sendCursor(int x, int y) {
+    if (useEvdev && input) {
+        int w = DisplayWidth(display, screen);
+        int h = DisplayHeight(display, screen);
+        input->moveMouse(x, y, w, h);
+    } else {
+        XWarpPointer(display, None, RootWindow(display, screen), 0, 0, 0, 0, x, y);
+        XFlush(display);
+    }
+}
+
+std::chrono::nanoseconds X11Platform::refreshInterval() {
+    short rate = 0;
+    XRRScreenConfiguration* config = XRRGetScreenInfo(display, RootWindow(display, screen));
+    if (config) {
+        rate = XRRConfigCurrentRate(config);
+        XRRFreeScreenConfigInfo(config);
+    }
+    if (rate <= 0) rate = 60;
+    LOG_INFO("X11Platform: Display refresh ", rate, " Hz");
+    return std::chrono::nanoseconds(1000000000LL / rate);
+}
+
 void X11Platform::clickMouse(int button, int count) {
+    // The click lands on the target, not wherever the glide has got to.
+    glide.finish();
+
     if (useEvdev && input) {
         input->clickMouse(button, count);
     } else {
+        // Same timing as the evdev path; the release steps fire from run().
         for (int i = 0; i < count; ++i) {
-            XTestFakeButtonEvent(display, button, True, CurrentTime);
-            XTestFakeButtonEvent(display, button, False, CurrentTime);
+            const auto pressDelay = (i == 0) ? std::chrono::milliseconds(0) : Config::DOUBLE_CLICK_DELAY;
+            injector.enqueue(pressDelay, [this, button] {
+                XTestFakeButtonEvent(display, button, True, CurrentTime);
+                XFlush(display);
+            });
+            injector.enqueue(Config::CLICK_PRESS_RELEASE_DELAY, [this, button] {
+                XTestFakeButtonEvent(display, button, False, CurrentTime);
+                XFlush(display);
+            });
         }
-        XFlush(display);
+    }
+}
+
+void X11Platform::afterClick(std::function<void()> step) {
+    if (useEvdev && input) {
+        // The virtual mouse's steps fire on the evdev thread; come back here.
+        input->afterClick([this, step]() { reactor.post(step); });
+    } else {
+        injector.enqueue(std::chrono::milliseconds(0), std::move(step));
     }
 }
 
@@ -5,6 +5,10 @@
 #include "../../core/Engine.h"
 #include "../../core/Input.h"
 #include "../../core/Overlay.h"
+#include "InjectionScheduler.h"
+#include "CursorGlide.h"
+#include "EventQueue.h"
+#include "Reactor.h"
 #include <X11/Xlib.h>
 #include <atomic>
 #include <memory>
@@ -12,6 +16,7 @@
 class X11Overlay; // Forward decl
 class X11Input;   // Forward decl
 class WaylandOverlay; // Forward decl
+class WlShmOverlay;   // Forward decl
 
 class X11Platform : public Platform {
 public:
@@ -31,33 +36,38 @@ public:
     void setupSignalHandling();
     void processSignal();
 
-    void moveCursor(int x, int y) override {
-        if (useEvdev && input) {
-            int w = DisplayWidth(display, screen);
-            int h = DisplayHeight(display, screen);
-            input->moveMouse(x, y, w, h);
-        } else {
-            XWarpPointer(display, None, RootWindow(display, screen), 0, 0, 0, 0, x, y);
-            XFlush(display);
-        }
-    }
+    // Jumps, or glides with Config::CURSOR_GLIDE
+    void moveCursor(int x, int y) override;
+    void warpCursor(int x, int y) override;
+    void setFrameTicks(bool enabled) override;
 
     void clickMouse(int button, int count) override;
+    void afterClick(std::function<void()> step) override;
 
     Display* getDisplay() const { return display; }
 
 private:
+    void sendCursor(int x, int y);
+    std::chrono::nanoseconds refreshInterval();
+
     Engine* engine;
     Display* display = nullptr;
     int screen = 0;
     int sigFd = -1;
+    int frameTimerFd = -1;       // Engine::onFrame ticks for precision motion
+    std::chrono::nanoseconds frameInterval{16666667};
     std::atomic<bool> isRunning{false};
     bool useEvdev = false;
     bool usingWaylandOverlay = false;
+    Reactor reactor;             // Owns every fd; Engine runs on its thread
+    EventQueue eventQueue;       // Decoded evdev events into the reactor
+    InjectionScheduler injector; // Timed XTest click steps, fired from run()
+    CursorGlide glide;           // Per-refresh pointer moves, fired from run()
 
     Overlay* overlay = nullptr;
     std::unique_ptr<X11Overlay> x11Overlay;
     std::unique_ptr<WaylandOverlay> waylandOverlay;
+    std::unique_ptr<WlShmOverlay> wlShmOverlay;
     std::unique_ptr<Input> input;
 };
 
@@ -0,0 +1,217 @@
+#include "X11ShmBuffers.h"
+#include "../../core/Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <poll.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+namespace {
+
+// How long beginFrame() waits for the server to release the back buffer
+// before drawing into it anyway.
+constexpr std::chrono::milliseconds COMPLETION_TIMEOUT(50);
+
+bool attachFailed = false;
+
+int onAttachError(Display*, XErrorEvent*) {
+    attachFailed = true;
+    return 0;
+}
+
+} // namespace
+
+X11ShmBuffers::X11ShmBuffers(Display* d, int s) : display(d), screen(s) {}
+
+X11ShmBuffers::~X11ShmBuffers() {
+    release();
+}
+
+bool X11ShmBuffers::resize(Window w, Visual* visual, int depth, int newWidth, int newHeight) {
+    release();
+    if (!display || !w || newWidth <= 0 || newHeight <= 0) return false;
+    if (!XShmQueryExtension(display)) {
+        LOG_INFO("X11ShmBuffers: MIT-SHM extension not available");
+        return false;
+    }
+
+    window = w;
+    width = newWidth;
+    height = newHeight;
+    gc = XCreateGC(display, window, 0, nullptr);
+    completionType = XShmGetEventBase(display) + ShmCompletion;
+
+    for (Buffer& buffer : buffers) {
+        if (!createBuffer(buffer, visual, depth)) {
+            release();
+            return false;
+        }
+    }
+    back = 0;
+    LOG_DEBUG("X11ShmBuffers: Created 2 buffers of ", width, "x", height);
+    return true;
+}
+
+bool X11ShmBuffers::createBuffer(Buffer& buffer, Visual* visual, int depth) {
+    buffer.image = XShmCreateImage(display, visual, depth, ZPixmap, nullptr, &buffer.segment, width, height);
+    if (!buffer.image) {
+        LOG_INFO("X11ShmBuffers: XShmCreateImage failed");
+        return false;
+    }
+
+    // Cairo's ARGB32 is native-endian 32 bpp, premultiplied, as is a local
+    // server's 32-bit TrueColor visual.
+    const uint32_t probe = 1;
+    const int nativeOrder = (*(const unsigned char*)&probe == 1) ? LSBFirst : MSBFirst;
+    if (buffer.image->bits_per_pixel != 32 || buffer.image->byte_order != nativeOrder ||
+        buffer.image->bytes_per_line != cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width)) {
+        LOG_INFO("X11ShmBuffers: Image layout does not match Cairo ARGB32");
+        return false;
+    }
+
+    const size_t bytes = (size_t)buffer.image->bytes_per_line * height;
+    buffer.segment.shmid = shmget(IPC_PRIVATE, bytes, IPC_CREAT | 0600);
+    if (buffer.segment.shmid < 0) {
+        LOG_INFO("X11ShmBuffers: shmget failed: ", strerror(errno));
+        return false;
+    }
+    buffer.segment.shmaddr = (char*)shmat(buffer.segment.shmid, nullptr, 0);
+    if (buffer.segment.shmaddr == (char*)-1) {
+        LOG_INFO("X11ShmBuffers: shmat failed: ", strerror(errno));
+        shmctl(buffer.segment.shmid, IPC_RMID, nullptr);
+        buffer.segment.shmaddr = nullptr;
+        return false;
+    }
+    buffer.segment.readOnly = False;
+    buffer.image->data = buffer.segment.shmaddr;
+
+    // A remote server accepts the extension query but refuses the attach.
+    XSync(display, False);
+    attachFailed = false;
+    XErrorHandler previous = XSetErrorHandler(onAttachError);
+    const Status attached = XShmAttach(display, &buffer.segment);
+    XSync(display, False);
+    XSetErrorHandler(previous);
+
+    // Removed now so the segment goes away with its last detach, even on a crash.
+    shmctl(buffer.segment.shmid, IPC_RMID, nullptr);
+    if (!attached || attachFailed) {
+        LOG_INFO("X11ShmBuffers: XShmAttach refused, server is probably remote");
+        shmdt(buffer.segment.shmaddr);
+        buffer.segment.shmaddr = nullptr;
+        buffer.image->data = nullptr;
+        return false;
+    }
+
+    buffer.surface = cairo_image_surface_create_for_data((unsigned char*)buffer.segment.shmaddr,
+                                                         CAIRO_FORMAT_ARGB32, width, height,
+                                                         buffer.image->bytes_per_line);
+    buffer.cr = cairo_create(buffer.surface);
+
+    // Fresh segments are zeroed, i.e. transparent; the window may show anything.
+    buffer.stale = {0.0, 0.0, (double)width, (double)height};
+    buffer.busy = false;
+    return true;
+}
+
+void X11ShmBuffers::destroyBuffer(Buffer& buffer) {
+    if (buffer.busy) waitForCompletion(buffer, COMPLETION_TIMEOUT);
+    if (buffer.cr) cairo_destroy(buffer.cr);
+    if (buffer.surface) cairo_surface_destroy(buffer.surface);
+    if (buffer.segment.shmaddr) {
+        XShmDetach(display, &buffer.segment);
+        XSync(display, False);
+        shmdt(buffer.segment.shmaddr);
+    }
+    if (buffer.image) {
+        buffer.image->data = nullptr; // Not ours to free
+        XDestroyImage(buffer.image);
+    }
+    buffer = Buffer();
+}
+
+void X11ShmBuffers::release() {
+    for (Buffer& buffer : buffers) destroyBuffer(buffer);
+    if (gc) XFreeGC(display, gc);
+    gc = nullptr;
+    window = 0;
+    width = 0;
+    height = 0;
+}
+
+cairo_t* X11ShmBuffers::beginFrame(Rect& area) {
+    Buffer& buffer = buffers[back];
+    if (buffer.busy) waitForCompletion(buffer, COMPLETION_TIMEOUT);
+    area = unionRect(area, buffer.stale);
+    return buffer.cr;
+}
+
+void X11ShmBuffers::present(const Rect& damage) {
+    Buffer& buffer = buffers[back];
+    cairo_surface_flush(buffer.surface);
+
+    const int x0 = std::max(0, (int)std::floor(damage.x));
+    const int y0 = std::max(0, (int)std::floor(damage.y));
+    const int x1 = std::min(width, (int)std::ceil(damage.x + damage.w));
+    const int y1 = std::min(height, (int)std::ceil(damage.y + damage.h));
+    if (x1 > x0 && y1 > y0) {
+        XShmPutImage(display, window, gc, buffer.image, x0, y0, x0, y0,
+                     (unsigned int)(x1 - x0), (unsigned int)(y1 - y0), True);
+        XFlush(display);
+        buffer.busy = true;
+        ++presentCount;
+    }
+
+    // This buffer now matches the window; the other one lacks this frame.
+    buffer.stale = {0.0, 0.0, 0.0, 0.0};
+    Buffer& other = buffers[1 - back];
+    other.stale = unionRect(other.stale, damage);
+    back = 1 - back;
+}
+
+void X11ShmBuffers::invalidate(const Rect& area) {
+    for (Buffer& buffer : buffers) buffer.stale = unionRect(buffer.stale, area);
+}
+
+bool X11ShmBuffers::handleEvent(const XEvent& event) {
+    if (completionType < 0 || event.type != completionType) return false;
+
+    const XShmCompletionEvent& completion = reinterpret_cast<const XShmCompletionEvent&>(event);
+    for (Buffer& buffer : buffers) {
+        if (buffer.image && buffer.segment.shmseg == completion.shmseg) buffer.busy = false;
+    }
+    return true;
+}
+
+void X11ShmBuffers::waitForCompletion(Buffer& buffer, std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    const int x11Fd = ConnectionNumber(display);
+    bool stalled = false;
+
+    while (buffer.busy) {
+        // Pull completions ourselves; the platform loop is blocked on us.
+        XEvent event;
+        if (XCheckTypedEvent(display, completionType, &event)) {
+            handleEvent(event);
+            continue;
+        }
+
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            LOG_WARN("X11ShmBuffers: No ShmCompletion after ", timeout.count(), "ms, reusing buffer");
+            buffer.busy = false;
+            break;
+        }
+        stalled = true;
+
+        struct pollfd pfd;
+        pfd.fd = x11Fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, (int)remaining.count() + 1) < 0 && errno != EINTR) break;
+    }
+    if (stalled) ++stallCount;
+}
@@ -0,0 +1,79 @@
+#ifndef X11SHMBUFFERS_H
+#define X11SHMBUFFERS_H
+
+#include "../../core/Types.h"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <cairo.h>
+#include <chrono>
+
+// Two client-side ARGB image buffers in MIT-SHM segments, presented to a
+// window with XShmPutImage. Cairo draws into memory, so a frame costs one
+// request per presented rect instead of one per fill and stroke.
+//
+// Buffers alternate: a frame is drawn into the back buffer while the server
+// may still be reading the one presented last. Each buffer tracks the area
+// where it differs from the window, so a frame repaints only that area and
+// its own damage.
+class X11ShmBuffers {
+public:
+    X11ShmBuffers(Display* display, int screen);
+    ~X11ShmBuffers();
+    X11ShmBuffers(const X11ShmBuffers&) = delete;
+    X11ShmBuffers& operator=(const X11ShmBuffers&) = delete;
+
+    // (Re)creates both buffers for a `width` x `height` window. Returns false
+    // if SHM is unusable (extension missing, remote server, byte order
+    // mismatch, attach refused); the caller then draws through Xlib.
+    bool resize(Window window, Visual* visual, int depth, int width, int height);
+    void release();
+    bool active() const { return buffers[0].surface != nullptr; }
+
+    // Context for the back buffer, after waiting for the server to finish
+    // reading it. `area` is widened by what the buffer is missing from
+    // earlier frames; draw at least that much.
+    cairo_t* beginFrame(Rect& area);
+
+    // Copies `damage` of the back buffer to the window and swaps buffers.
+    void present(const Rect& damage);
+
+    // Marks `area` of both buffers as out of date, for window contents
+    // changed without them.
+    void invalidate(const Rect& area);
+
+    // Consumes ShmCompletion events for our segments
+    bool handleEvent(const XEvent& event);
+
+    // Since creation; X11Overlay logs them on every hide
+    int presents() const { return presentCount; }
+    int stalls() const { return stallCount; } // beginFrame() had to wait for ShmCompletion
+
+private:
+    struct Buffer {
+        XShmSegmentInfo segment{};
+        XImage* image = nullptr;
+        cairo_surface_t* surface = nullptr;
+        cairo_t* cr = nullptr;
+        Rect stale{0.0, 0.0, 0.0, 0.0};
+        bool busy = false; // Presented, ShmCompletion not yet received
+    };
+
+    bool createBuffer(Buffer& buffer, Visual* visual, int depth);
+    void destroyBuffer(Buffer& buffer);
+    void waitForCompletion(Buffer& buffer, std::chrono::milliseconds timeout);
+
+    Display* display;
+    int screen;
+    Window window = 0;
+    GC gc = nullptr;
+    int completionType = -1;
+    int width = 0;
+    int height = 0;
+    Buffer buffers[2];
+    int back = 0;
+    int presentCount = 0;
+    int stallCount = 0;
+};
+
+#endif // X11SHMBUFFERS_H
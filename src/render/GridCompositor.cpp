@@ -0,0 +1,213 @@
+#include "GridCompositor.h"
+#include "GridRenderer.h"
+#include "SpanFill.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Pixel box, half-open on the right and bottom
+struct Box {
+    int x0, y0, x1, y1;
+};
+
+// Pixel interval along one axis
+struct Span {
+    int from, to;
+};
+
+struct Target {
+    cairo_surface_t* surface = nullptr;
+    unsigned char* data = nullptr;
+    int stride = 0;
+    int offsetX = 0; // User space to pixel space
+    int offsetY = 0;
+    std::vector<Box> clips;
+};
+
+bool isWhole(double value) {
+    return value == std::floor(value);
+}
+
+// Cairo's 24.8 fixed point coordinates
+int64_t toFixed(double value) {
+    return (int64_t)std::llround(value * 256.0);
+}
+
+// Cairo's CAIRO_ANTIALIAS_NONE rounding of a box edge: nearest pixel, halves down
+int roundEdge(int64_t fixed) {
+    return (int)std::floor((double)(fixed + 127) / 256.0);
+}
+
+Box roundBox(int64_t x0, int64_t y0, int64_t x1, int64_t y1) {
+    return {roundEdge(x0), roundEdge(y0), roundEdge(x1), roundEdge(y1)};
+}
+
+uint32_t pixelFor(const Config::Rgba& color) {
+    return SpanFill::premultiply(color.r, color.g, color.b, color.a);
+}
+
+bool findTarget(cairo_t* cr, Target& target) {
+    cairo_surface_t* surface = cairo_get_group_target(cr);
+    if (cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE ||
+        cairo_image_surface_get_format(surface) != CAIRO_FORMAT_ARGB32 ||
+        cairo_get_operator(cr) != CAIRO_OPERATOR_OVER) {
+        return false;
+    }
+
+    double scaleX = 1.0;
+    double scaleY = 1.0;
+    cairo_surface_get_device_scale(surface, &scaleX, &scaleY);
+    double deviceX = 0.0;
+    double deviceY = 0.0;
+    cairo_surface_get_device_offset(surface, &deviceX, &deviceY);
+    cairo_matrix_t matrix;
+    cairo_get_matrix(cr, &matrix);
+    if (scaleX != 1.0 || scaleY != 1.0 || matrix.xx != 1.0 || matrix.yy != 1.0 ||
+        matrix.xy != 0.0 || matrix.yx != 0.0) {
+        return false;
+    }
+    const double offsetX = matrix.x0 + deviceX;
+    const double offsetY = matrix.y0 + deviceY;
+    if (!isWhole(offsetX) || !isWhole(offsetY)) return false;
+
+    const int width = cairo_image_surface_get_width(surface);
+    const int height = cairo_image_surface_get_height(surface);
+    cairo_rectangle_list_t* list = cairo_copy_clip_rectangle_list(cr);
+    bool representable = list->status == CAIRO_STATUS_SUCCESS;
+    for (int i = 0; representable && i < list->num_rectangles; ++i) {
+        const cairo_rectangle_t& r = list->rectangles[i];
+        if (!isWhole(r.x) || !isWhole(r.y) || !isWhole(r.width) || !isWhole(r.height)) {
+            representable = false;
+            break;
+        }
+        const Box clip{std::max(0, (int)(r.x + offsetX)), std::max(0, (int)(r.y + offsetY)),
+                       std::min(width, (int)(r.x + r.width + offsetX)),
+                       std::min(height, (int)(r.y + r.height + offsetY))};
+        if (clip.x1 > clip.x0 && clip.y1 > clip.y0) target.clips.push_back(clip);
+    }
+    cairo_rectangle_list_destroy(list);
+    if (!representable) return false;
+
+    // Let Cairo finish pending drawing before the pixels are touched directly.
+    cairo_surface_flush(surface);
+    target.surface = surface;
+    target.data = cairo_image_surface_get_data(surface);
+    target.stride = cairo_image_surface_get_stride(surface);
+    target.offsetX = (int)offsetX;
+    target.offsetY = (int)offsetY;
+    return target.data != nullptr;
+}
+
+// Composites `color` over a box given in user space
+void fillBox(const Target& target, const Box& box, uint32_t color) {
+    for (const Box& clip : target.clips) {
+        const int x0 = std::max(clip.x0, box.x0 + target.offsetX);
+        const int y0 = std::max(clip.y0, box.y0 + target.offsetY);
+        const int x1 = std::min(clip.x1, box.x1 + target.offsetX);
+        const int y1 = std::min(clip.y1, box.y1 + target.offsetY);
+        if (x1 <= x0 || y1 <= y0) continue;
+
+        for (int y = y0; y < y1; ++y) {
+            uint32_t* row = reinterpret_cast<uint32_t*>(target.data + (size_t)y * target.stride);
+            SpanFill::fillOver(row + x0, x1 - x0, color);
+        }
+    }
+}
+
+// Overlapping spans merged, so that no pixel is covered twice
+std::vector<Span> merged(const std::vector<Span>& spans) {
+    std::vector<Span> out;
+    for (const Span& span : spans) {
+        if (span.to <= span.from) continue;
+        if (!out.empty() && span.from <= out.back().to) {
+            out.back().to = std::max(out.back().to, span.to);
+        } else {
+            out.push_back(span);
+        }
+    }
+    return out;
+}
+
+// All dividers are one Cairo stroke, which covers each pixel once even where
+// lines cross. Rows inside a horizontal divider get one span across the grid;
+// the remaining rows of the vertical dividers get one span per divider.
+void fillDividers(const Target& target, const GridLayout& local, int64_t half, uint32_t color) {
+    const Rect& bounds = local.bounds();
+    const int64_t left = toFixed(bounds.x);
+    const int64_t top = toFixed(bounds.y);
+    const int64_t right = toFixed(bounds.x + bounds.w);
+    const int64_t bottom = toFixed(bounds.y + bounds.h);
+
+    // Square caps extend each line by half the width.
+    std::vector<Span> columns;
+    for (int c = 1; c < local.cols(); ++c) {
+        const int64_t x = toFixed(local.colEdge(c));
+        columns.push_back({roundEdge(x - half), roundEdge(x + half)});
+    }
+    std::vector<Span> bands;
+    for (int r = 1; r < local.rows(); ++r) {
+        const int64_t y = toFixed(local.rowEdge(r));
+        bands.push_back({roundEdge(y - half), roundEdge(y + half)});
+    }
+    columns = merged(columns);
+    bands = merged(bands);
+
+    const Span across{roundEdge(left - half), roundEdge(right + half)};
+    const Span down{roundEdge(top - half), roundEdge(bottom + half)};
+    auto fillRows = [&](int y0, int y1, const std::vector<Span>& spans) {
+        for (const Span& span : spans) fillBox(target, {span.from, y0, span.to, y1}, color);
+    };
+
+    int y = down.from;
+    for (const Span& band : bands) {
+        if (!columns.empty()) fillRows(y, band.from, columns);
+        fillRows(band.from, band.to, {across});
+        y = band.to;
+    }
+    if (!columns.empty()) fillRows(y, down.to, columns);
+}
+
+} // namespace
+
+bool GridCompositor::drawLayer(cairo_t* cr, const GridLayout& local) {
+    if (local.empty()) return true;
+    const Rect& bounds = local.bounds();
+    if (!isWhole(bounds.x) || !isWhole(bounds.y) || !isWhole(bounds.w) || !isWhole(bounds.h)) return false;
+
+    // Cairo strokes a rectangle as four boxes only while its sides do not
+    // overlap; otherwise it goes through the tessellator.
+    const int64_t borderHalf = toFixed(GridRenderer::borderWidth(local) / 2.0);
+    const int64_t dividerHalf = toFixed(GridRenderer::dividerWidth(local) / 2.0);
+    const int64_t left = toFixed(bounds.x);
+    const int64_t top = toFixed(bounds.y);
+    const int64_t right = toFixed(bounds.x + bounds.w);
+    const int64_t bottom = toFixed(bounds.y + bounds.h);
+    if (right - left <= 2 * borderHalf || bottom - top <= 2 * borderHalf) return false;
+
+    Target target;
+    if (!findTarget(cr, target)) return false;
+    if (target.clips.empty()) return true;
+
+    // Tile fills; cells share edges but never overlap.
+    for (int index = 0; index < local.cellCount(); ++index) {
+        const Rect cell = local.cell(index);
+        const Box box = roundBox(toFixed(cell.x), toFixed(cell.y),
+                                 toFixed(cell.x + std::max(1.0, cell.w)), toFixed(cell.y + std::max(1.0, cell.h)));
+        fillBox(target, box, pixelFor(GridRenderer::tileColor(index)));
+    }
+
+    fillDividers(target, local, dividerHalf, pixelFor(GridRenderer::DIVIDER_COLOR));
+
+    // Outer border: top and bottom run the full width, the sides fill in between.
+    const uint32_t border = pixelFor(GridRenderer::BORDER_COLOR);
+    fillBox(target, roundBox(left - borderHalf, top - borderHalf, right + borderHalf, top + borderHalf), border);
+    fillBox(target, roundBox(left - borderHalf, top + borderHalf, left + borderHalf, bottom - borderHalf), border);
+    fillBox(target, roundBox(right - borderHalf, top + borderHalf, right + borderHalf, bottom - borderHalf), border);
+    fillBox(target, roundBox(left - borderHalf, bottom - borderHalf, right + borderHalf, bottom + borderHalf), border);
+
+    cairo_surface_mark_dirty(target.surface);
+    return true;
+}
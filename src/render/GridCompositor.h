@@ -0,0 +1,23 @@
+#ifndef GRIDCOMPOSITOR_H
+#define GRIDCOMPOSITOR_H
+
+#include "../core/GridLayout.h"
+#include <cairo.h>
+
+// Draws the static grid layer (tile fills, dividers and outer border) by
+// writing straight into the pixels of an ARGB32 image surface with
+// SpanFill, instead of rasterising it through Cairo. Every shape in the
+// layer is an axis-aligned box. The boxes are rounded as Cairo rounds them
+// under CAIRO_ANTIALIAS_NONE, so the output matches
+// GridRenderer::drawLayerUncached().
+class GridCompositor {
+public:
+    // Draws the layer of `local` onto the current target of `cr`, within its
+    // clip. Returns false without drawing unless the target is an ARGB32
+    // image surface, the operator is OVER, the transform is a whole-pixel
+    // translation and the clip is made of whole-pixel rectangles; the caller
+    // then draws through Cairo.
+    static bool drawLayer(cairo_t* cr, const GridLayout& local);
+};
+
+#endif // GRIDCOMPOSITOR_H
@@ -0,0 +1,116 @@
+#include "GridLayerCache.h"
+#include "../core/Config.h"
+#include "../core/Logger.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// FNV-1a over the bit patterns of the values.
+constexpr uint64_t FNV_OFFSET = 1469598103934665603ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t mix(uint64_t hash, double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (bits >> (i * 8)) & 0xff;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+} // namespace
+
+bool GridLayerCache::Key::operator==(const Key& other) const {
+    return rows == other.rows && cols == other.cols && w == other.w && h == other.h &&
+           palette == other.palette;
+}
+
+GridLayerCache::~GridLayerCache() {
+    for (Layer& layer : layers) cairo_surface_destroy(layer.surface);
+}
+
+GridLayerCache::Key GridLayerCache::keyFor(const GridLayout& local) {
+    const Rect& bounds = local.bounds();
+    Key key;
+    key.rows = local.rows();
+    key.cols = local.cols();
+    key.w = (int)bounds.w;
+    key.h = (int)bounds.h;
+
+    uint64_t hash = mix(FNV_OFFSET, Config::OVERLAY_FILL_ALPHA);
+    for (const Config::Rgba& color : Config::PALETTE) {
+        hash = mix(mix(mix(mix(hash, color.r), color.g), color.b), color.a);
+    }
+    for (int c = 1; c < key.cols; ++c) hash = mix(hash, local.colEdge(c) - bounds.x);
+    for (int r = 1; r < key.rows; ++r) hash = mix(hash, local.rowEdge(r) - bounds.y);
+    key.palette = hash;
+    return key;
+}
+
+void GridLayerCache::paint(cairo_t* cr, const GridLayout& local, DrawFn draw) {
+    if (local.empty()) return;
+
+    const Rect& bounds = local.bounds();
+    const double originX = bounds.x - LAYER_MARGIN;
+    const double originY = bounds.y - LAYER_MARGIN;
+    const int surfaceW = (int)bounds.w + 2 * (int)LAYER_MARGIN;
+    const int surfaceH = (int)bounds.h + 2 * (int)LAYER_MARGIN;
+
+    ++useClock;
+    const Key key = keyFor(local);
+    cairo_surface_t* surface = nullptr;
+    for (Layer& layer : layers) {
+        if (layer.key == key) {
+            layer.lastUse = useClock;
+            surface = layer.surface;
+            ++hitCount;
+            break;
+        }
+    }
+
+    if (!surface) {
+        ++missCount;
+        const size_t bytes = (size_t)cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, surfaceW) * surfaceH;
+        if (bytes > MAX_BYTES) {
+            draw(cr, local);
+            return;
+        }
+        evictFor(bytes);
+
+        surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, surfaceW, surfaceH);
+        cairo_t* layerCr = cairo_create(surface);
+        draw(layerCr, local.translated(-originX, -originY));
+        cairo_destroy(layerCr);
+        cairo_surface_flush(surface);
+
+        Layer layer;
+        layer.key = key;
+        layer.lastUse = useClock;
+        layer.bytes = bytes;
+        layer.surface = surface;
+        layers.push_back(layer);
+        totalBytes += bytes;
+        LOG_DEBUG("GridLayerCache: Rendered ", key.rows, "x", key.cols, " layer of ", key.w, "x", key.h,
+                  " (", hitCount, " hits, ", missCount, " misses, ", layers.size(), " layers)");
+    }
+
+    cairo_save(cr);
+    cairo_set_source_surface(cr, surface, originX, originY);
+    cairo_rectangle(cr, originX, originY, surfaceW, surfaceH);
+    cairo_fill(cr);
+    cairo_restore(cr);
+}
+
+void GridLayerCache::evictFor(size_t bytes) {
+    while (!layers.empty() && (layers.size() >= MAX_LAYERS || totalBytes + bytes > MAX_BYTES)) {
+        size_t oldest = 0;
+        for (size_t i = 1; i < layers.size(); ++i) {
+            if (layers[i].lastUse < layers[oldest].lastUse) oldest = i;
+        }
+        totalBytes -= layers[oldest].bytes;
+        cairo_surface_destroy(layers[oldest].surface);
+        layers.erase(layers.begin() + oldest);
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef GRIDLAYERCACHE_H
+#define GRIDLAYERCACHE_H
+
+#include "../core/GridLayout.h"
+#include <cairo.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Prerendered static grid layers: tile fills, dividers and outer border.
+// These depend only on the grid shape and size and on the palette, so a
+// frame can paint the cached layer instead of filling and stroking again.
+//
+// Layers are keyed by (rows, cols, w, h, palette hash). The key also covers
+// the edge snapping pattern, which can differ between grids of the same size.
+// The least recently used layers are evicted once the count or byte budget
+// is exceeded. A cache is not thread-safe; give each rendering thread its own.
+class GridLayerCache {
+public:
+    // Draws the static layer of `layout` onto a transparent surface
+    using DrawFn = void (*)(cairo_t* cr, const GridLayout& layout);
+
+    // Room around the bounds for the outer border, which is stroked centred on the edge
+    static constexpr double LAYER_MARGIN = 2.0;
+
+    GridLayerCache() = default;
+    ~GridLayerCache();
+    GridLayerCache(const GridLayerCache&) = delete;
+    GridLayerCache& operator=(const GridLayerCache&) = delete;
+
+    // Paints the static layer of `local` onto `cr`, rendering it first on a miss.
+    // Layers too large for the byte budget are drawn directly instead.
+    void paint(cairo_t* cr, const GridLayout& local, DrawFn draw);
+
+    int hits() const { return hitCount; }
+    int misses() const { return missCount; }
+
+private:
+    struct Key {
+        int rows = 0;
+        int cols = 0;
+        int w = 0;
+        int h = 0;
+        uint64_t palette = 0; // Palette, fill alpha and edge pattern
+        bool operator==(const Key& other) const;
+    };
+
+    struct Layer {
+        Key key;
+        uint64_t lastUse = 0;
+        size_t bytes = 0;
+        cairo_surface_t* surface = nullptr;
+    };
+
+    static Key keyFor(const GridLayout& local);
+    void evictFor(size_t bytes);
+
+    static constexpr size_t MAX_LAYERS = 6;
+    static constexpr size_t MAX_BYTES = 64u << 20;
+    std::vector<Layer> layers;
+    size_t totalBytes = 0;
+    uint64_t useClock = 0;
+    int hitCount = 0;
+    int missCount = 0;
+};
+
+#endif // GRIDLAYERCACHE_H
@@ -0,0 +1,186 @@
+#include "GridRenderer.h"
+#include "GridCompositor.h"
+#include "../core/Config.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+double clampValue(double value, double minValue, double maxValue) {
+    return std::max(minValue, std::min(value, maxValue));
+}
+
+// Layer surfaces of the cache are image surfaces, so they get span fills too.
+void drawLayerComposited(cairo_t* cr, const GridLayout& local) {
+    if (!GridCompositor::drawLayer(cr, local)) GridRenderer::drawLayerUncached(cr, local);
+}
+
+} // namespace
+
+bool GridRenderer::fitToSurface(GridLayout& local, int surfaceW, int surfaceH) {
+    const Rect layoutRect = local.bounds();
+    Rect drawRect = layoutRect;
+
+    // Keep draw rect within sane values to avoid rendering artifacts.
+    drawRect.x = std::max(drawRect.x, -drawRect.w);
+    drawRect.y = std::max(drawRect.y, -drawRect.h);
+    drawRect.w = std::max(1.0, drawRect.w);
+    drawRect.h = std::max(1.0, drawRect.h);
+
+    // Snap near-fullscreen rects to exact pixel bounds to avoid visible margins.
+    if (std::abs(drawRect.x) <= 2.0) drawRect.x = 0.0;
+    if (std::abs(drawRect.y) <= 2.0) drawRect.y = 0.0;
+    if (std::abs((drawRect.x + drawRect.w) - surfaceW) <= 2.0) drawRect.w = std::max(1.0, (double)surfaceW - drawRect.x);
+    if (std::abs((drawRect.y + drawRect.h) - surfaceH) <= 2.0) drawRect.h = std::max(1.0, (double)surfaceH - drawRect.y);
+
+    // Guard against transient inset geometries captured during activation.
+    // If the rect is still "mostly fullscreen" but detached from surface edges,
+    // force a full-surface draw to avoid corner gaps.
+    const double surfaceArea = std::max(1.0, (double)surfaceW * (double)surfaceH);
+    const double drawArea = drawRect.w * drawRect.h;
+    const bool nearFullscreenArea = drawArea >= surfaceArea * 0.65;
+    const bool touchesLeftOrRight = drawRect.x <= 2.0 || (drawRect.x + drawRect.w) >= ((double)surfaceW - 2.0);
+    const bool touchesTopOrBottom = drawRect.y <= 2.0 || (drawRect.y + drawRect.h) >= ((double)surfaceH - 2.0);
+    if (nearFullscreenArea && (!touchesLeftOrRight || !touchesTopOrBottom)) {
+        drawRect = {0.0, 0.0, (double)surfaceW, (double)surfaceH};
+    }
+
+    // The engine's layout is used as-is unless the rect had to be corrected above.
+    if (sameRect(drawRect, layoutRect)) return false;
+    local.assign(drawRect, local.rows(), local.cols());
+    return true;
+}
+
+Config::Rgba GridRenderer::tileColor(int index) {
+    if (Config::PALETTE.empty()) return {0.0, 0.0, 0.0, Config::OVERLAY_FILL_ALPHA};
+    const Config::Rgba& color = Config::PALETTE[index % Config::PALETTE.size()];
+    return {color.r, color.g, color.b, Config::OVERLAY_FILL_ALPHA};
+}
+
+double GridRenderer::dividerWidth(const GridLayout& local) {
+    const Rect& bounds = local.bounds();
+    const double minCell = std::min(bounds.w / local.cols(), bounds.h / local.rows());
+    return clampValue(minCell * 0.010, 1.0, 2.0);
+}
+
+double GridRenderer::borderWidth(const GridLayout& local) {
+    const Rect& bounds = local.bounds();
+    const double minCell = std::min(bounds.w / local.cols(), bounds.h / local.rows());
+    return clampValue(minCell * 0.012, 1.2, 2.4);
+}
+
+double GridRenderer::labelFontSize(const GridLayout& local) {
+    const Rect& bounds = local.bounds();
+    const double minCell = std::min(bounds.w / local.cols(), bounds.h / local.rows());
+    const double fontSizeMultiplier = (local.cols() == 6) ? 0.35 : 0.25;
+    return clampValue(minCell * fontSizeMultiplier, 12.0, 72.0);
+}
+
+Rect GridRenderer::drawnExtent(const GridFrame& frame) {
+    const GridLayout& local = frame.layout;
+    const Rect& bounds = local.bounds();
+    if (frame.showPoint) {
+        const double cx = std::floor(bounds.x + bounds.w / 2.0);
+        const double cy = std::floor(bounds.y + bounds.h / 2.0);
+        return {cx - 7.0, cy - 7.0, 15.0, 15.0};
+    }
+    const double minCell = std::min(bounds.w / local.cols(), bounds.h / local.rows());
+    const double margin = std::ceil(3.0 + std::max(0.0, 1.5 * labelFontSize(local) - minCell));
+    return {bounds.x - margin, bounds.y - margin, bounds.w + 2 * margin, bounds.h + 2 * margin};
+}
+
+void GridRenderer::draw(cairo_t* cr, const GridFrame& frame) {
+    if (frame.showPoint) {
+        drawPoint(cr, frame.layout);
+        return;
+    }
+    drawLayer(cr, frame.layout);
+    drawLabels(cr, frame.layout);
+}
+
+void GridRenderer::drawLayer(cairo_t* cr, const GridLayout& local) {
+    // Image surfaces (MIT-SHM, wl_shm) get the layer written straight into
+    // their pixels, which is cheaper than blending a cached copy over them.
+    if (GridCompositor::drawLayer(cr, local)) return;
+    layers.paint(cr, local, drawLayerComposited);
+}
+
+void GridRenderer::drawLabels(cairo_t* cr, const GridLayout& local) {
+    // Masks are pixel-aligned and the ink is centred on the anchor.
+    const std::vector<LabelAtlas::Glyph>& glyphs =
+        labels.labels((int)std::lround(labelFontSize(local)), local.cols(), local.cellCount());
+    cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 1.0);
+
+    for (int index = 0; index < local.cellCount(); ++index) {
+        const LabelAtlas::Glyph& glyph = glyphs[index];
+        if (!glyph.mask) continue;
+
+        const double maskX = std::round(local.labelAnchorX(index) - glyph.width * 0.5);
+        const double maskY = std::round(local.labelAnchorY(index) - glyph.height * 0.5);
+        cairo_mask_surface(cr, glyph.mask, maskX, maskY);
+    }
+}
+
+void GridRenderer::drawPoint(cairo_t* cr, const GridLayout& local) {
+    // Small high-visibility target point at the center
+    const Rect drawRect = local.bounds();
+    const double cx = drawRect.x + drawRect.w / 2.0;
+    const double cy = drawRect.y + drawRect.h / 2.0;
+    const double radius = 4.0;
+
+    cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+    cairo_set_source_rgba(cr, 1.0, 0.0, 0.0, 0.8); // Red point
+    cairo_arc(cr, cx, cy, radius, 0, 2 * M_PI);
+    cairo_fill(cr);
+
+    cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 0.9); // White border
+    cairo_set_line_width(cr, 1.5);
+    cairo_arc(cr, cx, cy, radius, 0, 2 * M_PI);
+    cairo_stroke(cr);
+}
+
+void GridRenderer::drawLayerUncached(cairo_t* cr, const GridLayout& local) {
+    const Rect drawRect = local.bounds();
+    const int gridRows = local.rows();
+    const int gridCols = local.cols();
+
+    // Rectangular production layout: edge-to-edge cells, no spacing.
+    cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+    cairo_set_line_join(cr, CAIRO_LINE_JOIN_MITER);
+    cairo_set_line_cap(cr, CAIRO_LINE_CAP_SQUARE);
+
+    const double gridStroke = dividerWidth(local);
+    const double borderStroke = borderWidth(local);
+
+    // Draw contiguous translucent cells (no gap).
+    for (int index = 0; index < local.cellCount(); ++index) {
+        const Rect cell = local.cell(index);
+        const Config::Rgba fill = tileColor(index);
+
+        cairo_rectangle(cr, cell.x, cell.y, std::max(1.0, cell.w), std::max(1.0, cell.h));
+        cairo_set_source_rgba(cr, fill.r, fill.g, fill.b, fill.a);
+        cairo_fill(cr);
+    }
+
+    // Grid dividers.
+    cairo_set_source_rgba(cr, DIVIDER_COLOR.r, DIVIDER_COLOR.g, DIVIDER_COLOR.b, DIVIDER_COLOR.a);
+    cairo_set_line_width(cr, gridStroke);
+    for (int c = 1; c < gridCols; ++c) {
+        const double x = local.colEdge(c);
+        cairo_move_to(cr, x, drawRect.y);
+        cairo_line_to(cr, x, drawRect.y + drawRect.h);
+    }
+    for (int r = 1; r < gridRows; ++r) {
+        const double y = local.rowEdge(r);
+        cairo_move_to(cr, drawRect.x, y);
+        cairo_line_to(cr, drawRect.x + drawRect.w, y);
+    }
+    cairo_stroke(cr);
+
+    // Outer border end-to-end.
+    cairo_set_source_rgba(cr, BORDER_COLOR.r, BORDER_COLOR.g, BORDER_COLOR.b, BORDER_COLOR.a);
+    cairo_set_line_width(cr, borderStroke);
+    cairo_rectangle(cr, drawRect.x, drawRect.y, drawRect.w, drawRect.h);
+    cairo_stroke(cr);
+}
@@ -0,0 +1,63 @@
+#ifndef GRIDRENDERER_H
+#define GRIDRENDERER_H
+
+#include "../core/Config.h"
+#include "../core/GridLayout.h"
+#include "../core/Types.h"
+#include "GridLayerCache.h"
+#include "LabelAtlas.h"
+#include <cairo.h>
+
+// One overlay frame. The layout is in the target surface's coordinates;
+// showPoint draws only the target point at its centre.
+struct GridFrame {
+    GridLayout layout;
+    bool showPoint = false;
+};
+
+// Backend-neutral grid drawing, shared by the X11 and Wayland overlays and by
+// RenderBench. draw() paints the frame over whatever is on `cr`, so callers
+// clip and clear first. A renderer owns a static-layer cache and a label
+// atlas and is not thread-safe; give each rendering thread its own.
+class GridRenderer {
+public:
+    // Keeps `local` drawable on a surfaceW x surfaceH surface: clamps the rect,
+    // snaps edges within 2px of the surface edges, and widens a mostly
+    // fullscreen rect that is detached from the edges to the whole surface.
+    // Returns true if the layout had to be rebuilt.
+    static bool fitToSurface(GridLayout& local, int surfaceW, int surfaceH);
+
+    // Pixel-aligned area that draw() touches: the border is stroked centred
+    // on the outer edge, labels can overhang cells smaller than the minimum
+    // font size, and the target point overhangs the centre.
+    static Rect drawnExtent(const GridFrame& frame);
+
+    static double labelFontSize(const GridLayout& local);
+
+    // Colours and line widths of the static layer
+    static constexpr Config::Rgba DIVIDER_COLOR{0.92, 0.95, 1.0, 0.25};
+    static constexpr Config::Rgba BORDER_COLOR{0.96, 0.97, 1.0, 0.75};
+    static Config::Rgba tileColor(int index);
+    static double dividerWidth(const GridLayout& local);
+    static double borderWidth(const GridLayout& local);
+
+    void draw(cairo_t* cr, const GridFrame& frame);
+
+    // Stages of draw()
+    void drawLayer(cairo_t* cr, const GridLayout& local);
+    void drawLabels(cairo_t* cr, const GridLayout& local);
+    static void drawPoint(cairo_t* cr, const GridLayout& local);
+
+    // Tile fills, dividers and outer border through Cairo, bypassing the
+    // layer cache and GridCompositor
+    static void drawLayerUncached(cairo_t* cr, const GridLayout& local);
+
+    const GridLayerCache& layerCache() const { return layers; }
+    const LabelAtlas& labelAtlas() const { return labels; }
+
+private:
+    GridLayerCache layers;
+    LabelAtlas labels;
+};
+
+#endif // GRIDRENDERER_H
@@ -0,0 +1,84 @@
+#include "LabelAtlas.h"
+#include "../core/GridLayout.h"
+#include "../core/Logger.h"
+#include <cmath>
+#include <string>
+
+LabelAtlas::~LabelAtlas() {
+    for (LabelSet& set : sets) release(set);
+}
+
+const std::vector<LabelAtlas::Glyph>& LabelAtlas::labels(int fontPx, int cols, int count) {
+    ++useClock;
+    for (LabelSet& set : sets) {
+        if (set.fontPx == fontPx && set.cols == cols && set.count == count) {
+            set.lastUse = useClock;
+            ++hitCount;
+            return set.glyphs;
+        }
+    }
+
+    ++missCount;
+    LabelSet* slot = nullptr;
+    if (sets.size() < MAX_SETS) {
+        sets.emplace_back();
+        slot = &sets.back();
+    } else {
+        slot = &sets.front();
+        for (LabelSet& set : sets) {
+            if (set.lastUse < slot->lastUse) slot = &set;
+        }
+        release(*slot);
+    }
+
+    slot->fontPx = fontPx;
+    slot->cols = cols;
+    slot->count = count;
+    slot->lastUse = useClock;
+    rasterise(*slot);
+    LOG_DEBUG("LabelAtlas: Rasterised ", count, " labels at ", fontPx, "px (", hitCount, " hits, ",
+              missCount, " misses)");
+    return slot->glyphs;
+}
+
+void LabelAtlas::rasterise(LabelSet& set) {
+    set.glyphs.assign(set.count, Glyph());
+
+    // Scratch context for measuring; the font is looked up once per set.
+    cairo_surface_t* scratch = cairo_image_surface_create(CAIRO_FORMAT_A8, 1, 1);
+    cairo_t* measure = cairo_create(scratch);
+    cairo_select_font_face(measure, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(measure, set.fontPx);
+
+    for (int index = 0; index < set.count; ++index) {
+        const std::string label = GridLayout::labelForIndex(index, set.cols);
+        if (label.empty()) continue;
+
+        cairo_text_extents_t extents;
+        cairo_text_extents(measure, label.c_str(), &extents);
+
+        // One pixel of padding on each side keeps antialiased edges intact.
+        Glyph& glyph = set.glyphs[index];
+        glyph.width = (int)std::ceil(extents.width) + 2;
+        glyph.height = (int)std::ceil(extents.height) + 2;
+        glyph.mask = cairo_image_surface_create(CAIRO_FORMAT_A8, glyph.width, glyph.height);
+
+        cairo_t* cr = cairo_create(glyph.mask);
+        cairo_set_font_face(cr, cairo_get_font_face(measure));
+        cairo_set_font_size(cr, set.fontPx);
+        cairo_move_to(cr, 1.0 - extents.x_bearing, 1.0 - extents.y_bearing);
+        cairo_show_text(cr, label.c_str());
+        cairo_destroy(cr);
+        cairo_surface_flush(glyph.mask);
+    }
+
+    cairo_destroy(measure);
+    cairo_surface_destroy(scratch);
+}
+
+void LabelAtlas::release(LabelSet& set) {
+    for (Glyph& glyph : set.glyphs) {
+        if (glyph.mask) cairo_surface_destroy(glyph.mask);
+    }
+    set.glyphs.clear();
+}
@@ -0,0 +1,55 @@
+#ifndef LABELATLAS_H
+#define LABELATLAS_H
+
+#include <cairo.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Rasterised grid labels. Each label of a label set is drawn once into an
+// A8 mask. Frames then composite the masks with cairo_mask_surface, so
+// steady-state frames do no font lookup, text layout or allocation.
+//
+// A label set is keyed by (font size in whole pixels, grid cols, cell count).
+// The cols value selects the labelling scheme, see GridLayout::labelForIndex.
+// A few sets are kept, least recently used first out. An atlas is not
+// thread-safe; give each rendering thread its own.
+class LabelAtlas {
+public:
+    struct Glyph {
+        cairo_surface_t* mask = nullptr; // Null for cells without a label
+        int width = 0;                   // Mask size; the ink is centred in it
+        int height = 0;
+    };
+
+    LabelAtlas() = default;
+    ~LabelAtlas();
+    LabelAtlas(const LabelAtlas&) = delete;
+    LabelAtlas& operator=(const LabelAtlas&) = delete;
+
+    // Glyphs for cells 0..count-1, rasterised on first use
+    const std::vector<Glyph>& labels(int fontPx, int cols, int count);
+
+    int hits() const { return hitCount; }
+    int misses() const { return missCount; }
+
+private:
+    struct LabelSet {
+        int fontPx = 0;
+        int cols = 0;
+        int count = 0;
+        uint64_t lastUse = 0;
+        std::vector<Glyph> glyphs;
+    };
+
+    static void rasterise(LabelSet& set);
+    static void release(LabelSet& set);
+
+    static constexpr size_t MAX_SETS = 4;
+    std::vector<LabelSet> sets;
+    uint64_t useClock = 0;
+    int hitCount = 0;
+    int missCount = 0;
+};
+
+#endif // LABELATLAS_H
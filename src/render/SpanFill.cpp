@@ -0,0 +1,157 @@
+#include "SpanFill.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SPANFILL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr uint32_t RB_MASK = 0x00ff00ff;
+constexpr uint32_t RB_ONE_HALF = 0x00800080;
+constexpr uint32_t RB_MASK_PLUS_ONE = 0x01000100;
+
+// pixman's UN8x4_MUL_UN8: each channel of x times a / 255, rounded
+uint32_t mulChannels(uint32_t x, uint32_t a) {
+    uint32_t rb = (x & RB_MASK) * a + RB_ONE_HALF;
+    rb = ((rb + ((rb >> 8) & RB_MASK)) >> 8) & RB_MASK;
+    uint32_t ag = ((x >> 8) & RB_MASK) * a + RB_ONE_HALF;
+    ag = (ag + ((ag >> 8) & RB_MASK)) & ~RB_MASK;
+    return rb | ag;
+}
+
+// pixman's UN8x4_ADD_UN8x4: per-channel saturating add
+uint32_t addChannels(uint32_t x, uint32_t y) {
+    uint32_t rb = (x & RB_MASK) + (y & RB_MASK);
+    rb = (rb | (RB_MASK_PLUS_ONE - ((rb >> 8) & RB_MASK))) & RB_MASK;
+    uint32_t ag = ((x >> 8) & RB_MASK) + ((y >> 8) & RB_MASK);
+    ag = (ag | (RB_MASK_PLUS_ONE - ((ag >> 8) & RB_MASK))) & RB_MASK;
+    return rb | (ag << 8);
+}
+
+void fillOverScalar(uint32_t* dst, int count, uint32_t color) {
+    const uint32_t inverseAlpha = 255 - (color >> 24);
+    for (int i = 0; i < count; ++i) {
+        dst[i] = addChannels(color, mulChannels(dst[i], inverseAlpha));
+    }
+}
+
+#ifdef SPANFILL_X86
+
+// Same arithmetic as pixman-sse2: x * a + 0x80, then * 0x0101 >> 16.
+__attribute__((target("sse2")))
+void fillOverSse2(uint32_t* dst, int count, uint32_t color) {
+    const __m128i src = _mm_set1_epi32((int)color);
+    const __m128i alpha = _mm_set1_epi16((short)(255 - (color >> 24)));
+    const __m128i half = _mm_set1_epi16(0x0080);
+    const __m128i scale = _mm_set1_epi16(0x0101);
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(dst + i);
+        const __m128i d = _mm_loadu_si128(p);
+        __m128i lo = _mm_unpacklo_epi8(d, zero);
+        __m128i hi = _mm_unpackhi_epi8(d, zero);
+        lo = _mm_mulhi_epu16(_mm_adds_epu16(_mm_mullo_epi16(lo, alpha), half), scale);
+        hi = _mm_mulhi_epu16(_mm_adds_epu16(_mm_mullo_epi16(hi, alpha), half), scale);
+        _mm_storeu_si128(p, _mm_adds_epu8(_mm_packus_epi16(lo, hi), src));
+    }
+    fillOverScalar(dst + i, count - i, color);
+}
+
+__attribute__((target("avx2")))
+void fillOverAvx2(uint32_t* dst, int count, uint32_t color) {
+    const __m256i src = _mm256_set1_epi32((int)color);
+    const __m256i alpha = _mm256_set1_epi16((short)(255 - (color >> 24)));
+    const __m256i half = _mm256_set1_epi16(0x0080);
+    const __m256i scale = _mm256_set1_epi16(0x0101);
+    const __m256i zero = _mm256_setzero_si256();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(dst + i);
+        const __m256i d = _mm256_loadu_si256(p);
+        // Unpack and pack both work per 128-bit lane, so pixel order is kept.
+        __m256i lo = _mm256_unpacklo_epi8(d, zero);
+        __m256i hi = _mm256_unpackhi_epi8(d, zero);
+        lo = _mm256_mulhi_epu16(_mm256_adds_epu16(_mm256_mullo_epi16(lo, alpha), half), scale);
+        hi = _mm256_mulhi_epu16(_mm256_adds_epu16(_mm256_mullo_epi16(hi, alpha), half), scale);
+        _mm256_storeu_si256(p, _mm256_adds_epu8(_mm256_packus_epi16(lo, hi), src));
+    }
+    fillOverSse2(dst + i, count - i, color);
+}
+
+#endif // SPANFILL_X86
+
+using FillFn = void (*)(uint32_t* dst, int count, uint32_t color);
+
+FillFn fillFor(SpanFill::Impl impl) {
+    switch (impl) {
+#ifdef SPANFILL_X86
+        case SpanFill::Impl::Avx2: return fillOverAvx2;
+        case SpanFill::Impl::Sse2: return fillOverSse2;
+#endif
+        default: return fillOverScalar;
+    }
+}
+
+void fillWith(FillFn fill, uint32_t* dst, int count, uint32_t color) {
+    if (count <= 0 || color == 0) return;
+    if ((color >> 24) == 255) {
+        std::fill_n(dst, count, color);
+        return;
+    }
+    fill(dst, count, color);
+}
+
+} // namespace
+
+namespace SpanFill {
+
+bool supported(Impl impl) {
+    switch (impl) {
+        case Impl::Scalar: return true;
+#ifdef SPANFILL_X86
+        case Impl::Sse2: return __builtin_cpu_supports("sse2");
+        case Impl::Avx2: return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+Impl best() {
+    static const Impl impl = supported(Impl::Avx2) ? Impl::Avx2
+                           : supported(Impl::Sse2) ? Impl::Sse2
+                           : Impl::Scalar;
+    return impl;
+}
+
+const char* name(Impl impl) {
+    switch (impl) {
+        case Impl::Sse2: return "sse2";
+        case Impl::Avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+uint32_t premultiply(double r, double g, double b, double a) {
+    // Cairo clamps the colour and keeps 16-bit premultiplied channels;
+    // pixman takes their high byte.
+    auto clamp = [](double value) { return std::max(0.0, std::min(value, 1.0)); };
+    auto channel = [](double value) { return (uint32_t)(value * 65535.0 + 0.5) >> 8; };
+    a = clamp(a);
+    return channel(a) << 24 | channel(clamp(r) * a) << 16 | channel(clamp(g) * a) << 8 | channel(clamp(b) * a);
+}
+
+void fillOver(uint32_t* dst, int count, uint32_t color) {
+    static const FillFn fill = fillFor(best());
+    fillWith(fill, dst, count, color);
+}
+
+void fillOver(Impl impl, uint32_t* dst, int count, uint32_t color) {
+    fillWith(fillFor(impl), dst, count, color);
+}
+
+} // namespace SpanFill
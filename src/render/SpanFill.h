@@ -0,0 +1,35 @@
+#ifndef SPANFILL_H
+#define SPANFILL_H
+
+#include <cstdint>
+
+// Solid span fills for premultiplied ARGB32 pixels, as Cairo and pixman
+// store them in image surfaces. fillOver() composites one colour OVER a run
+// of pixels with pixman's rounding, so the result matches a Cairo fill of
+// the same pixels. The SIMD variants are picked once at startup from CPUID;
+// all of them give identical output.
+namespace SpanFill {
+
+enum class Impl {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// Fastest variant this CPU supports
+Impl best();
+bool supported(Impl impl);
+const char* name(Impl impl);
+
+// Cairo's 8-bit premultiplied pixel for a source colour
+uint32_t premultiply(double r, double g, double b, double a);
+
+// dst[0..count-1] = color OVER dst[i], with the best variant
+void fillOver(uint32_t* dst, int count, uint32_t color);
+
+// Same with a given variant, which must be supported
+void fillOver(Impl impl, uint32_t* dst, int count, uint32_t color);
+
+} // namespace SpanFill
+
+#endif // SPANFILL_H
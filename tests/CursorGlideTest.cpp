@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "../src/platform/linux/CursorGlide.h"
+#include <poll.h>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Clock = CursorGlide::Clock;
+using std::chrono::milliseconds;
+
+struct Recorder {
+    std::vector<std::pair<int, int>> moves;
+
+    CursorGlide::Move move() {
+        return [this](int x, int y) { moves.emplace_back(x, y); };
+    }
+};
+
+} // namespace
+
+TEST(CursorGlideTest, EasingStartsFastAndArrivesGently) {
+    EXPECT_DOUBLE_EQ(CursorGlide::ease(0.0), 0.0);
+    EXPECT_DOUBLE_EQ(CursorGlide::ease(1.0), 1.0);
+    EXPECT_DOUBLE_EQ(CursorGlide::ease(2.0), 1.0);
+    EXPECT_GT(CursorGlide::ease(0.5), 0.5);
+    EXPECT_GT(CursorGlide::ease(0.2) - CursorGlide::ease(0.1), CursorGlide::ease(0.9) - CursorGlide::ease(0.8));
+}
+
+TEST(CursorGlideTest, FollowsTheClockToTheTarget) {
+    Recorder recorder;
+    CursorGlide glide(recorder.move());
+    ASSERT_TRUE(glide.initialize());
+    glide.setDuration(milliseconds(100));
+
+    const auto t0 = Clock::now();
+    glide.glideTo(0, 0, 1000, 500, t0);
+    EXPECT_TRUE(glide.active());
+    ASSERT_EQ(recorder.moves.size(), 1u);
+    EXPECT_EQ(recorder.moves.back(), std::make_pair(0, 0));
+
+    EXPECT_TRUE(glide.advance(t0 + milliseconds(50)));
+    EXPECT_EQ(recorder.moves.back(), std::make_pair(875, 438));
+
+    // A late frame jumps straight to where the curve is now
+    EXPECT_FALSE(glide.advance(t0 + milliseconds(150)));
+    EXPECT_FALSE(glide.active());
+    EXPECT_EQ(recorder.moves.back(), std::make_pair(1000, 500));
+    EXPECT_EQ(recorder.moves.size(), 3u);
+}
+
+TEST(CursorGlideTest, RetargetsFromWhereItHasGot) {
+    Recorder recorder;
+    CursorGlide glide(recorder.move());
+    ASSERT_TRUE(glide.initialize());
+    glide.setDuration(milliseconds(100));
+
+    const auto t0 = Clock::now();
+    glide.glideTo(0, 0, 1000, 0, t0);
+    glide.advance(t0 + milliseconds(50));
+    ASSERT_EQ(recorder.moves.back(), std::make_pair(875, 0));
+
+    // The new key's glide ignores its `from` and carries on from x = 875
+    glide.glideTo(0, 0, 875, 400, t0 + milliseconds(50));
+    EXPECT_EQ(recorder.moves.back(), std::make_pair(875, 0));
+    glide.advance(t0 + milliseconds(100));
+    EXPECT_EQ(recorder.moves.back(), std::make_pair(875, 350));
+    EXPECT_FALSE(glide.advance(t0 + milliseconds(150)));
+    EXPECT_EQ(recorder.moves.back(), std::make_pair(875, 400));
+}
+
+TEST(CursorGlideTest, FinishJumpsToTheTarget) {
+    Recorder recorder;
+    CursorGlide glide(recorder.move());
+    ASSERT_TRUE(glide.initialize());
+
+    glide.glideTo(10, 10, 300, 200);
+    glide.finish();
+    EXPECT_FALSE(glide.active());
+    EXPECT_EQ(recorder.moves.back(), std::make_pair(300, 200));
+
+    // Nothing more arrives from the disarmed timer
+    struct pollfd pfd = {glide.fd(), POLLIN, 0};
+    EXPECT_EQ(poll(&pfd, 1, 40), 0);
+}
+
+TEST(CursorGlideTest, TimerEmitsFramesUntilArrival) {
+    Recorder recorder;
+    CursorGlide glide(recorder.move());
+    ASSERT_TRUE(glide.initialize());
+    glide.setDuration(milliseconds(50));
+    glide.setFrameInterval(milliseconds(5));
+
+    glide.glideTo(0, 0, 500, 0);
+    struct pollfd pfd = {glide.fd(), POLLIN, 0};
+    while (glide.active()) {
+        ASSERT_EQ(poll(&pfd, 1, 1000), 1);
+        glide.dispatch();
+    }
+    EXPECT_GT(recorder.moves.size(), 3u);
+    EXPECT_EQ(recorder.moves.back(), std::make_pair(500, 0));
+    for (size_t i = 1; i < recorder.moves.size(); ++i) {
+        EXPECT_GT(recorder.moves[i].first, recorder.moves[i - 1].first);
+    }
+}
+
+TEST(CursorGlideTest, JumpsWithoutATimer) {
+    Recorder recorder;
+    CursorGlide glide(recorder.move());
+    glide.glideTo(0, 0, 40, 60);
+    EXPECT_FALSE(glide.active());
+    EXPECT_EQ(recorder.moves, (std::vector<std::pair<int, int>>{{40, 60}}));
+}
@@ -1,50 +1,7 @@
 #include <gtest/gtest.h>
 #include "../src/core/Engine.h"
-#include "../src/core/Platform.h"
-#include "../src/core/Input.h"
-#include "../src/core/Overlay.h"
 #include "../src/core/Config.h"
-
-// --- Mocks ---
-class MockPlatform : public Platform {
-public:
-    int cursorX = 0, cursorY = 0;
-    int clicks = 0;
-
-    bool initialize() override { return true; }
-    void run() override {}
-    void exit() override {}
-    void releaseModifiers() override {}
-    void getScreenSize(int& w, int& h) override { w = 1920; h = 1080; }
-    void moveCursor(int x, int y) override { cursorX = x; cursorY = y; }
-    void clickMouse(int button, int count) override { clicks += count; }
-};
-
-class MockOverlay : public Overlay {
-public:
-    int updates = 0;
-    bool isVisible = false;
-    bool lastShowPoint = false;
-
-    void show() override { isVisible = true; }
-    void hide() override { isVisible = false; }
-    void updateGrid(int rows, int cols, double x, double y, double w, double h, bool showPoint) override { 
-        updates++; 
-        lastShowPoint = showPoint;
-    }
-    bool getBounds(Rect& out) override { out = {0, 0, 1920, 1080}; return true; }
-};
-
-class MockInput : public Input {
-public:
-    bool grabbed = false;
-
-    bool initialize(int w, int h) override { return true; }
-    void grabKeyboard() override { grabbed = true; }
-    void ungrabKeyboard() override { grabbed = false; }
-    void moveMouse(int x, int y, int sw, int sh) override {}
-    void clickMouse(int button, int count) override {}
-};
+#include "Mocks.h"
 
 // --- Test Fixture ---
 class EngineTest : public ::testing::Test {
@@ -60,6 +17,11 @@ protected:
         Config::LEVEL1_GRID_ROWS = 5;
         Config::LEVEL1_GRID_COLS = 5;
         Config::MAX_RECURSION_DEPTH = 1;
+        Config::POST_UNGRAB_DELAY = std::chrono::milliseconds(50);
+        Config::PRECISION_MIN_SPEED = 40.0;
+        Config::PRECISION_MAX_SPEED = 1200.0;
+        Config::PRECISION_RAMP = std::chrono::milliseconds(800);
+        Config::PRECISION_CURVE = 2.0;
         
         engine.setPlatform(&platform);
         engine.setOverlay(&overlay);
@@ -127,12 +89,258 @@ TEST_F(EngineTest, TargetPointAndHoldToClick) {
     EXPECT_TRUE(overlay.lastShowPoint);
     EXPECT_TRUE(input.grabbed);
     
-    engine.onControlKey("space"); 
+    engine.onAction(KeyAction::LeftClick); 
     EXPECT_EQ(platform.clicks, 1);
     EXPECT_FALSE(input.grabbed); 
     EXPECT_FALSE(overlay.isVisible);
 }
 
+TEST_F(EngineTest, ActivationUsesSettledBounds) {
+    // Backend confirms a larger monitor than the platform's initial estimate.
+    class SettlingOverlay : public MockOverlay {
+    public:
+        int waits = 0;
+        bool waitForSettledBounds(Rect& out, std::chrono::milliseconds) override {
+            waits++;
+            out = {0, 0, 2560, 1440};
+            return true;
+        }
+    } settlingOverlay;
+    engine.setOverlay(&settlingOverlay);
+
+    engine.onActivate();
+    EXPECT_EQ(settlingOverlay.waits, 1);
+    engine.onChar('a', false);
+    engine.onChar('a', false);
+
+    EXPECT_EQ(platform.cursorX, 128);
+    EXPECT_EQ(platform.cursorY, 72);
+}
+
+TEST_F(EngineTest, ClickHandoffDoesNotWaitForFullDelayWhenConfirmed) {
+    Config::POST_UNGRAB_DELAY = std::chrono::milliseconds(5000);
+    engine.onActivate();
+
+    const auto start = std::chrono::steady_clock::now();
+    engine.onClick(1, 1, true);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(platform.clicks, 1);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(1000));
+}
+
+TEST_F(EngineTest, ClickHandoffFallsBackToDelayWhenUnconfirmed) {
+    // Backend never confirms the unmap; the click must still go out.
+    class StuckOverlay : public MockOverlay {
+    public:
+        bool waitUntilHidden(std::chrono::milliseconds timeout) override {
+            lastTimeout = timeout;
+            return false;
+        }
+        std::chrono::milliseconds lastTimeout{-1};
+    } stuckOverlay;
+    engine.setOverlay(&stuckOverlay);
+
+    engine.onActivate();
+    engine.onClick(1, 1, true);
+
+    EXPECT_EQ(platform.clicks, 1);
+    EXPECT_LE(stuckOverlay.lastTimeout, Config::POST_UNGRAB_DELAY);
+}
+
+TEST_F(EngineTest, StayClickReshowsOverlayAfterLastRelease) {
+    platform.deferClicks = true;
+    engine.onActivate();
+    engine.onChar('a', false);
+    engine.onChar('a', false);
+
+    engine.onClick(1, 2, false);
+    EXPECT_EQ(platform.clicks, 2);
+    EXPECT_FALSE(overlay.isVisible); // Later presses must not land on the overlay
+    ASSERT_EQ(platform.pendingSteps.size(), 1u);
+    platform.pendingSteps.front()();
+    EXPECT_TRUE(overlay.isVisible);
+    EXPECT_TRUE(input.grabbed);
+
+    // Deactivated before the release went out: stays hidden
+    platform.pendingSteps.clear();
+    engine.onClick(1, 1, false);
+    engine.onDeactivate();
+    platform.pendingSteps.front()();
+    EXPECT_FALSE(overlay.isVisible);
+}
+
+TEST_F(EngineTest, DispatchRoutesQueuedEvents) {
+    EngineEvent event;
+    event.type = EngineEventType::Activate;
+    engine.dispatch(event);
+    EXPECT_TRUE(input.grabbed);
+
+    event.type = EngineEventType::Char;
+    event.c = 'b';
+    engine.dispatch(event);
+    engine.dispatch(event);
+    EXPECT_EQ(platform.cursorX, 192 + 96);
+    EXPECT_EQ(platform.cursorY, 108 + 54);
+
+    event.type = EngineEventType::Action;
+    event.action = KeyAction::LeftClick;
+    engine.dispatch(event);
+    EXPECT_EQ(platform.clicks, 1);
+    EXPECT_FALSE(input.grabbed);
+}
+
+TEST_F(EngineTest, FirstCharPrerendersRowCandidates) {
+    engine.onActivate();
+    engine.onChar('c', false);
+    ASSERT_EQ(overlay.prerendered.size(), 10u);
+
+    engine.onChar('d', false);
+    const GridLayout& candidate = overlay.prerendered[3];
+    EXPECT_EQ(overlay.lastLayout.rows(), candidate.rows());
+    EXPECT_EQ(overlay.lastLayout.cols(), candidate.cols());
+    EXPECT_EQ(overlay.lastLayout.bounds().x, candidate.bounds().x);
+    EXPECT_EQ(overlay.lastLayout.bounds().y, candidate.bounds().y);
+    EXPECT_EQ(overlay.lastLayout.bounds().w, candidate.bounds().w);
+    EXPECT_EQ(overlay.lastLayout.bounds().h, candidate.bounds().h);
+}
+
+TEST_F(EngineTest, PrecisionModeSteersWithHeldKeys) {
+    engine.onActivate();
+    engine.onChar('a', false);
+    engine.onChar('a', false);
+    engine.onAction(KeyAction::Precision);
+    EXPECT_FALSE(overlay.isVisible);
+    EXPECT_TRUE(input.grabbed);
+
+    engine.onAction(KeyAction::MoveRight);
+    EXPECT_TRUE(platform.frameTicks);
+    const auto t0 = std::chrono::steady_clock::now();
+    engine.onFrame(t0 + std::chrono::milliseconds(100));
+    EXPECT_GT(platform.cursorX, 96);
+    EXPECT_EQ(platform.cursorY, 54);
+
+    engine.onActionRelease(KeyAction::MoveRight);
+    EXPECT_FALSE(platform.frameTicks);
+    const int stoppedX = platform.cursorX;
+    engine.onFrame(t0 + std::chrono::milliseconds(200));
+    EXPECT_EQ(platform.cursorX, stoppedX);
+
+    // h/j/k/l steer too instead of picking cells
+    engine.onChar('k', false);
+    EXPECT_TRUE(platform.frameTicks);
+    engine.onFrame(std::chrono::steady_clock::now() + std::chrono::milliseconds(100));
+    EXPECT_EQ(platform.cursorX, stoppedX);
+    EXPECT_LT(platform.cursorY, 54);
+    engine.onKeyRelease('k');
+    EXPECT_FALSE(platform.frameTicks);
+
+    engine.onAction(KeyAction::LeftClick);
+    EXPECT_EQ(platform.clicks, 1);
+    EXPECT_FALSE(input.grabbed);
+}
+
+TEST_F(EngineTest, PrecisionMotionAccumulatesSubPixels) {
+    Config::PRECISION_MIN_SPEED = 10.0;
+    Config::PRECISION_MAX_SPEED = 10.0;
+    engine.onActivate();
+    engine.onChar('a', false);
+    engine.onChar('a', false);
+    engine.onAction(KeyAction::Precision);
+
+    engine.onAction(KeyAction::MoveDown);
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<int> ys;
+    for (int frame = 1; frame <= 10; ++frame) {
+        engine.onFrame(t0 + std::chrono::milliseconds(20 * frame));
+        ys.push_back(platform.cursorY);
+    }
+    // 0.2 px per frame: one pixel every five frames, never a skipped or repeated step
+    EXPECT_EQ(ys, (std::vector<int>{54, 54, 55, 55, 55, 55, 55, 56, 56, 56}));
+}
+
+TEST_F(EngineTest, PrecisionMotionAcceleratesAndStaysOnScreen) {
+    Config::PRECISION_MIN_SPEED = 100.0;
+    Config::PRECISION_MAX_SPEED = 1000.0;
+    Config::PRECISION_RAMP = std::chrono::milliseconds(1000);
+    Config::PRECISION_CURVE = 1.0;
+    engine.onActivate();
+    engine.onChar('e', false);
+    engine.onChar('e', false);
+    engine.onAction(KeyAction::Precision);
+    ASSERT_EQ(platform.cursorX, 768 + 96);
+
+    engine.onAction(KeyAction::MoveLeft);
+    const auto t0 = std::chrono::steady_clock::now();
+    engine.onFrame(t0 + std::chrono::milliseconds(100));
+    const int firstStep = 864 - platform.cursorX;
+    engine.onFrame(t0 + std::chrono::milliseconds(800));
+    const int x = platform.cursorX;
+    engine.onFrame(t0 + std::chrono::milliseconds(900));
+    EXPECT_GT(x - platform.cursorX, 3 * firstStep);
+
+    // A stalled loop moves one capped frame, and the edge holds the pointer
+    for (int frame = 1; frame <= 30; ++frame) {
+        engine.onFrame(t0 + std::chrono::seconds(frame));
+    }
+    EXPECT_EQ(platform.cursorX, 0);
+
+    // Undo goes back to the cell
+    engine.onUndo();
+    EXPECT_TRUE(overlay.isVisible);
+    EXPECT_FALSE(platform.frameTicks);
+    EXPECT_EQ(platform.cursorX, 864);
+}
+
+TEST_F(EngineTest, PrecisionEntersAtMaxDepthWhileFinalKeyIsHeld) {
+    engine.onActivate();
+    engine.onChar('a', false);
+    engine.onChar('a', false);
+    engine.onChar('m', false); // Level1 centre cell, the last level
+    engine.onAction(KeyAction::Precision);
+    ASSERT_EQ(platform.cursorX, 96);
+    ASSERT_EQ(platform.cursorY, 54);
+
+    // Releasing the final key no longer deactivates
+    engine.onKeyRelease('m');
+    EXPECT_TRUE(input.grabbed);
+    EXPECT_FALSE(overlay.isVisible);
+
+    engine.onAction(KeyAction::MoveDown);
+    engine.onFrame(std::chrono::steady_clock::now() + std::chrono::milliseconds(100));
+    engine.onActionRelease(KeyAction::MoveDown);
+    EXPECT_EQ(platform.cursorX, 96);
+    EXPECT_GT(platform.cursorY, 54);
+}
+
+TEST_F(EngineTest, PrecisionToggleKeepsTheAdjustedPointer) {
+    engine.onActivate();
+    engine.onChar('a', false);
+    engine.onChar('a', false);
+    engine.onAction(KeyAction::Precision);
+    engine.onAction(KeyAction::MoveRight);
+    engine.onFrame(std::chrono::steady_clock::now() + std::chrono::milliseconds(100));
+    engine.onActionRelease(KeyAction::MoveRight);
+    const int adjustedX = platform.cursorX;
+    ASSERT_GT(adjustedX, 96);
+
+    // Toggling off brings the grid back without moving the pointer
+    engine.onAction(KeyAction::Precision);
+    EXPECT_TRUE(overlay.isVisible);
+    EXPECT_EQ(platform.cursorX, adjustedX);
+
+    // Toggling on again resumes from there
+    engine.onAction(KeyAction::Precision);
+    EXPECT_EQ(platform.cursorX, adjustedX);
+    engine.onAction(KeyAction::Precision);
+
+    // And a click lands there
+    platform.cursorX = 0;
+    engine.onAction(KeyAction::LeftClick);
+    EXPECT_EQ(platform.clicks, 1);
+    EXPECT_EQ(platform.cursorX, adjustedX);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
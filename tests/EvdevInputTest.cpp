@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "../src/platform/linux/EvdevInput.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Empty stand-in for /dev/input, removed with everything created in it
+struct TempInputDir {
+    std::string path;
+
+    TempInputDir() {
+        char pattern[] = "/tmp/keynav-input-XXXXXX";
+        path = mkdtemp(pattern);
+    }
+
+    ~TempInputDir() {
+        std::string command = "rm -rf '" + path + "'";
+        std::system(command.c_str());
+    }
+};
+
+template<typename Predicate>
+bool waitFor(Predicate predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(EvdevInputTest, IdleLoopNeverWakesUp) {
+    TempInputDir dir;
+    EventQueue queue;
+    ASSERT_TRUE(queue.initialize());
+    EvdevInput input(&queue, dir.path);
+    ASSERT_TRUE(input.start());
+
+    // The old loop polled with a 100 ms timeout and would have woken ~5 times.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    EXPECT_EQ(input.wakeups(), 0u);
+}
+
+TEST(EvdevInputTest, WakesForNewNodesAndIgnoresNonKeyboards) {
+    TempInputDir dir;
+    EventQueue queue;
+    ASSERT_TRUE(queue.initialize());
+    EvdevInput input(&queue, dir.path);
+    ASSERT_TRUE(input.start());
+
+    // A regular file fails the EVIOCGBIT keyboard probe.
+    FILE* node = std::fopen((dir.path + "/event7").c_str(), "w");
+    ASSERT_NE(node, nullptr);
+    std::fclose(node);
+
+    EXPECT_TRUE(waitFor([&input] { return input.wakeups() > 0; }));
+    EXPECT_EQ(input.keyboardCount(), 0u);
+}
+
+TEST(EvdevInputTest, ShutdownDoesNotWaitForATimeout) {
+    TempInputDir dir;
+    EventQueue queue;
+    ASSERT_TRUE(queue.initialize());
+
+    auto input = std::make_unique<EvdevInput>(&queue, dir.path);
+    ASSERT_TRUE(input->start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    const auto begin = std::chrono::steady_clock::now();
+    input.reset();
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(50));
+}
+
+TEST(EvdevInputTest, RecognisesKeyboardsFromSysfsCapabilities) {
+    // AT keyboard and USB keyboard as reported on 64-bit kernels
+    EXPECT_TRUE(EvdevInput::isKeyboardCapability("402000000 3803078f800d001 feffffdfffefffff fffffffffffffffe\n"));
+    EXPECT_TRUE(EvdevInput::isKeyboardCapability("1000000000007 ff9f207ac14057ff febeffdfffefffff fffffffffffffffe"));
+
+    // Power button, touchpad, lid switch and a media-key-only device
+    EXPECT_FALSE(EvdevInput::isKeyboardCapability("10000000000000 0"));
+    EXPECT_FALSE(EvdevInput::isKeyboardCapability("e520 10000 0 0 0 0"));
+    EXPECT_FALSE(EvdevInput::isKeyboardCapability("0"));
+    EXPECT_FALSE(EvdevInput::isKeyboardCapability("3e000b00000000 0 0 0"));
+    EXPECT_FALSE(EvdevInput::isKeyboardCapability(""));
+}
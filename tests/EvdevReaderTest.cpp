@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include "../src/platform/linux/EvdevReader.h"
+#include "../src/platform/linux/EvdevFrame.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Non-blocking pipe standing in for an evdev node
+struct FakeDevice {
+    int fds[2] = {-1, -1};
+
+    FakeDevice() { EXPECT_EQ(pipe2(fds, O_NONBLOCK), 0); }
+    ~FakeDevice() {
+        if (fds[0] >= 0) close(fds[0]);
+        if (fds[1] >= 0) close(fds[1]);
+    }
+
+    int fd() const { return fds[0]; }
+
+    void send(const std::vector<struct input_event>& events) {
+        const ssize_t size = (ssize_t)(events.size() * sizeof(struct input_event));
+        ASSERT_EQ(write(fds[1], events.data(), size), size);
+    }
+
+    void unplug() {
+        close(fds[1]);
+        fds[1] = -1;
+    }
+};
+
+struct input_event event(int type, int code, int value) {
+    struct input_event ev = {};
+    ev.type = (uint16_t)type;
+    ev.code = (uint16_t)code;
+    ev.value = value;
+    return ev;
+}
+
+// What the kernel sends for one key press or release
+void appendKey(std::vector<struct input_event>& events, int code, int value) {
+    events.push_back(event(EV_MSC, MSC_SCAN, 0x70000 + code));
+    events.push_back(event(EV_KEY, code, value));
+    events.push_back(event(EV_SYN, SYN_REPORT, 0));
+}
+
+struct Recorder {
+    std::vector<size_t> frameSizes;
+    std::vector<int> keys;
+
+    EvdevReader::FrameHandler handler() {
+        return [this](const struct input_event* frame, size_t count) {
+            frameSizes.push_back(count);
+            for (size_t i = 0; i < count; ++i) {
+                if (frame[i].type == EV_KEY) keys.push_back(frame[i].code);
+            }
+        };
+    }
+};
+
+} // namespace
+
+TEST(EvdevReaderTest, OneReadDispatchesEveryPendingFrame) {
+    FakeDevice device;
+    std::vector<struct input_event> events;
+    appendKey(events, KEY_A, 1);
+    appendKey(events, KEY_A, 0);
+    appendKey(events, KEY_B, 1);
+    device.send(events);
+
+    EvdevReader reader;
+    Recorder recorder;
+    EXPECT_TRUE(reader.readFrames(device.fd(), recorder.handler()));
+    EXPECT_EQ(reader.reads(), 1u);
+    EXPECT_EQ(recorder.frameSizes, (std::vector<size_t>{3, 3, 3}));
+    EXPECT_EQ(recorder.keys, (std::vector<int>{KEY_A, KEY_A, KEY_B}));
+}
+
+TEST(EvdevReaderTest, FramesSplitAcrossBatchesStayWhole) {
+    FakeDevice device;
+    std::vector<struct input_event> events;
+    for (int i = 0; i < 30; ++i) appendKey(events, KEY_1 + i % 10, i % 2);
+    device.send(events);
+
+    EvdevReader reader;
+    Recorder recorder;
+    EXPECT_TRUE(reader.readFrames(device.fd(), recorder.handler()));
+    // 90 events: a full batch of 64, then the remaining 26 behind the carried frame.
+    EXPECT_EQ(reader.reads(), 2u);
+    EXPECT_EQ(recorder.frameSizes, std::vector<size_t>(30, 3));
+    EXPECT_EQ(recorder.keys.size(), 30u);
+}
+
+TEST(EvdevReaderTest, UnfinishedFrameWaitsForItsReport) {
+    FakeDevice device;
+    device.send({event(EV_MSC, MSC_SCAN, 4), event(EV_KEY, KEY_C, 1)});
+
+    EvdevReader reader;
+    Recorder recorder;
+    EXPECT_TRUE(reader.readFrames(device.fd(), recorder.handler()));
+    EXPECT_TRUE(recorder.frameSizes.empty());
+
+    device.send({event(EV_SYN, SYN_REPORT, 0)});
+    EXPECT_TRUE(reader.readFrames(device.fd(), recorder.handler()));
+    EXPECT_EQ(recorder.frameSizes, (std::vector<size_t>{3}));
+    EXPECT_EQ(recorder.keys, (std::vector<int>{KEY_C}));
+}
+
+TEST(EvdevReaderTest, DropsTheFrameTheKernelDropped) {
+    FakeDevice device;
+    std::vector<struct input_event> events = {event(EV_KEY, KEY_X, 1), event(EV_SYN, SYN_DROPPED, 0),
+                                              event(EV_KEY, KEY_Y, 1), event(EV_SYN, SYN_REPORT, 0)};
+    appendKey(events, KEY_Z, 1);
+    device.send(events);
+
+    EvdevReader reader;
+    Recorder recorder;
+    EXPECT_TRUE(reader.readFrames(device.fd(), recorder.handler()));
+    EXPECT_EQ(recorder.keys, (std::vector<int>{KEY_Z}));
+}
+
+TEST(EvdevReaderTest, ReportsAGoneDevice) {
+    FakeDevice device;
+    device.unplug();
+
+    EvdevReader reader;
+    Recorder recorder;
+    EXPECT_FALSE(reader.readFrames(device.fd(), recorder.handler()));
+}
+
+TEST(EvdevReaderTest, TracksHeldKeys) {
+    FakeDevice device;
+    std::vector<struct input_event> events;
+    appendKey(events, KEY_LEFTALT, 1);
+    appendKey(events, KEY_G, 1);
+    appendKey(events, KEY_G, 2); // Autorepeat keeps it down
+    appendKey(events, KEY_LEFTALT, 0);
+    device.send(events);
+
+    EvdevReader reader;
+    Recorder recorder;
+    EXPECT_TRUE(reader.readFrames(device.fd(), recorder.handler()));
+    EXPECT_TRUE(reader.isDown(KEY_G));
+    EXPECT_FALSE(reader.isDown(KEY_LEFTALT));
+    EXPECT_FALSE(reader.isDown(KEY_ESC));
+
+    reader.markReleased(KEY_G);
+    EXPECT_FALSE(reader.isDown(KEY_G));
+}
+
+TEST(EvdevFrameTest, SubmitsEveryEventWithOneWrite) {
+    FakeDevice device;
+    EvdevFrame frame;
+    frame.add(EV_KEY, KEY_LEFTALT, 0);
+    frame.add(EV_KEY, KEY_RIGHTALT, 0);
+    frame.add(EV_KEY, KEY_G, 0);
+    EXPECT_TRUE(frame.submit(device.fds[1]));
+    EXPECT_TRUE(frame.empty());
+
+    // One pipe write is one read; the frame arrives whole with its report.
+    EvdevReader reader;
+    Recorder recorder;
+    EXPECT_TRUE(reader.readFrames(device.fd(), recorder.handler()));
+    EXPECT_EQ(recorder.frameSizes, (std::vector<size_t>{4}));
+    EXPECT_EQ(recorder.keys, (std::vector<int>{KEY_LEFTALT, KEY_RIGHTALT, KEY_G}));
+}
+
+TEST(EvdevFrameTest, KeepsRoomForTheReport) {
+    FakeDevice device;
+    EvdevFrame frame;
+    for (size_t i = 0; i < EvdevFrame::MAX_EVENTS + 5; ++i) frame.add(EV_KEY, KEY_A, 0);
+    EXPECT_TRUE(frame.submit(device.fds[1]));
+
+    struct input_event events[EvdevFrame::MAX_EVENTS + 1];
+    const ssize_t n = read(device.fd(), events, sizeof(events));
+    ASSERT_EQ(n, (ssize_t)(EvdevFrame::MAX_EVENTS * sizeof(struct input_event)));
+    EXPECT_EQ(events[EvdevFrame::MAX_EVENTS - 1].type, EV_SYN);
+    EXPECT_EQ(events[EvdevFrame::MAX_EVENTS - 1].code, SYN_REPORT);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "../src/render/GridCompositor.h"
+#include "../src/render/GridRenderer.h"
+#include <cairo.h>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+
+// Image surface pre-filled with a translucent background
+struct TestSurface {
+    cairo_surface_t* surface;
+    cairo_t* cr;
+
+    TestSurface(int w, int h, bool withBackground)
+        : surface(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h)), cr(cairo_create(surface)) {
+        if (withBackground) {
+            cairo_set_source_rgba(cr, 0.2, 0.6, 0.4, 0.5);
+            cairo_rectangle(cr, 0, 0, w / 2, h);
+            cairo_fill(cr);
+            cairo_set_source_rgba(cr, 0.9, 0.1, 0.3, 0.8);
+            cairo_rectangle(cr, w / 3, 0, w / 3, h);
+            cairo_fill(cr);
+        }
+    }
+
+    ~TestSurface() {
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+    }
+};
+
+// Largest per-channel difference between two surfaces of the same size
+int maxChannelDiff(cairo_surface_t* a, cairo_surface_t* b) {
+    cairo_surface_flush(a);
+    cairo_surface_flush(b);
+    const int w = cairo_image_surface_get_width(a);
+    const int h = cairo_image_surface_get_height(a);
+    int worst = 0;
+    for (int y = 0; y < h; ++y) {
+        const uint32_t* rowA = reinterpret_cast<const uint32_t*>(cairo_image_surface_get_data(a) + y * cairo_image_surface_get_stride(a));
+        const uint32_t* rowB = reinterpret_cast<const uint32_t*>(cairo_image_surface_get_data(b) + y * cairo_image_surface_get_stride(b));
+        for (int x = 0; x < w; ++x) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                const int diff = std::abs((int)((rowA[x] >> shift) & 0xff) - (int)((rowB[x] >> shift) & 0xff));
+                if (diff > worst) worst = diff;
+            }
+        }
+    }
+    return worst;
+}
+
+// Draws `layout` through Cairo and through GridCompositor under the same
+// state and returns the largest difference.
+template<typename Setup>
+int compare(int w, int h, const GridLayout& layout, bool withBackground, Setup setup) {
+    TestSurface expected(w, h, withBackground);
+    TestSurface actual(w, h, withBackground);
+    setup(expected.cr);
+    setup(actual.cr);
+
+    GridRenderer::drawLayerUncached(expected.cr, layout);
+    EXPECT_TRUE(GridCompositor::drawLayer(actual.cr, layout));
+    return maxChannelDiff(expected.surface, actual.surface);
+}
+
+} // namespace
+
+TEST(GridCompositorTest, MatchesCairoForEveryGrid) {
+    const int sizes[][2] = {{1920, 1080}, {2560, 1440}, {1366, 768}};
+    for (const auto& size : sizes) {
+        const Rect full{0.0, 0.0, (double)size[0], (double)size[1]};
+        for (int cells : {6, 11, 26}) {
+            EXPECT_LE(compare(size[0], size[1], GridLayout(full, cells, cells), false, [](cairo_t*) {}), 1)
+                << size[0] << "x" << size[1] << " level 0 grid " << cells;
+        }
+
+        // Level 1 grids inside a level 0 cell, down to cells of a few pixels
+        const GridLayout parent(full, 11, 11);
+        GridLayout inner;
+        for (int cells : {3, 6, 9}) {
+            inner.assign(parent.cell(60), cells, cells);
+            EXPECT_LE(compare(size[0], size[1], inner, false, [](cairo_t*) {}), 1)
+                << size[0] << "x" << size[1] << " level 1 grid " << cells;
+        }
+        const GridLayout tiny(inner.cell(0), 6, 6);
+        EXPECT_LE(compare(size[0], size[1], tiny, false, [](cairo_t*) {}), 1);
+    }
+}
+
+TEST(GridCompositorTest, MatchesCairoOverContentWithClipAndTranslation) {
+    const GridLayout layout({-40.0, 30.0, 900.0, 500.0}, 6, 11);
+    const int diff = compare(800, 600, layout, true, [](cairo_t* cr) {
+        cairo_translate(cr, 17.0, -9.0);
+        cairo_rectangle(cr, 100.0, 50.0, 300.0, 400.0);
+        cairo_rectangle(cr, 500.0, 0.0, 120.0, 120.0);
+        cairo_clip(cr);
+    });
+    EXPECT_LE(diff, 1);
+}
+
+TEST(GridCompositorTest, DeclinesTargetsItCannotMatch) {
+    const GridLayout layout({0.0, 0.0, 400.0, 300.0}, 6, 6);
+
+    TestSurface translated(400, 300, false);
+    cairo_translate(translated.cr, 0.5, 0.0);
+    EXPECT_FALSE(GridCompositor::drawLayer(translated.cr, layout));
+
+    TestSurface scaled(400, 300, false);
+    cairo_scale(scaled.cr, 2.0, 2.0);
+    EXPECT_FALSE(GridCompositor::drawLayer(scaled.cr, layout));
+
+    TestSurface clipped(400, 300, false);
+    cairo_rectangle(clipped.cr, 10.25, 10.0, 100.0, 100.0);
+    cairo_clip(clipped.cr);
+    EXPECT_FALSE(GridCompositor::drawLayer(clipped.cr, layout));
+
+    cairo_surface_t* recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+    cairo_t* cr = cairo_create(recording);
+    EXPECT_FALSE(GridCompositor::drawLayer(cr, layout));
+    cairo_destroy(cr);
+    cairo_surface_destroy(recording);
+}
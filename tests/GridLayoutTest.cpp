@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include "../src/core/GridLayout.h"
+#include <cmath>
+
+TEST(GridLayoutTest, EdgesAreSnappedAndContiguous) {
+    // 1920 / 11 and 1080 / 11 are fractional.
+    GridLayout layout({0.0, 0.0, 1920.0, 1080.0}, 11, 11);
+
+    EXPECT_EQ(layout.colEdge(0), 0.0);
+    EXPECT_EQ(layout.colEdge(11), 1920.0);
+    EXPECT_EQ(layout.rowEdge(11), 1080.0);
+    for (int c = 0; c <= 11; ++c) EXPECT_EQ(layout.colEdge(c), std::round(layout.colEdge(c)));
+
+    for (int c = 0; c + 1 < 11; ++c) {
+        const Rect left = layout.cell(0, c);
+        const Rect right = layout.cell(0, c + 1);
+        EXPECT_EQ(left.x + left.w, right.x);
+    }
+}
+
+TEST(GridLayoutTest, CentersAndAnchorsLieInsideCells) {
+    GridLayout layout({100.0, 50.0, 174.5, 98.2}, 6, 6);
+
+    for (int index = 0; index < layout.cellCount(); ++index) {
+        const Rect cell = layout.cell(index);
+        EXPECT_GE(layout.centerX(index), cell.x);
+        EXPECT_LT(layout.centerX(index), cell.x + cell.w);
+        EXPECT_GE(layout.centerY(index), cell.y);
+        EXPECT_LT(layout.centerY(index), cell.y + cell.h);
+        EXPECT_DOUBLE_EQ(layout.labelAnchorX(index), cell.x + cell.w / 2.0);
+    }
+    EXPECT_EQ(layout.label(0), "A");
+    EXPECT_EQ(layout.label(27), "1");
+}
+
+TEST(GridLayoutTest, TranslationKeepsPixelAlignment) {
+    GridLayout root({1920.0, 0.0, 1920.0, 1080.0}, 11, 11);
+    GridLayout local = root.translated(-1920.0, 0.0);
+
+    EXPECT_EQ(local.bounds().x, 0.0);
+    EXPECT_EQ(local.colEdge(3), root.colEdge(3) - 1920.0);
+    EXPECT_EQ(local.centerX(5), root.centerX(5) - 1920);
+    EXPECT_EQ(local.label(12), "BB");
+}
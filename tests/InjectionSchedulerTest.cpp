@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "../src/platform/linux/InjectionScheduler.h"
+#include <poll.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::chrono::milliseconds;
+
+namespace {
+
+struct Log {
+    std::mutex mutex;
+    std::vector<int> steps;
+
+    void add(int step) {
+        std::lock_guard<std::mutex> lock(mutex);
+        steps.push_back(step);
+    }
+    std::vector<int> get() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return steps;
+    }
+};
+
+bool waitReadable(int fd) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    return poll(&pfd, 1, 1000) == 1;
+}
+
+} // namespace
+
+TEST(InjectionSchedulerTest, RunsStepsInOrderOnTheTimer) {
+    InjectionScheduler scheduler;
+    ASSERT_TRUE(scheduler.initialize());
+    Log log;
+
+    scheduler.enqueue(milliseconds(0), [&] { log.add(1); }); // Nothing pending: runs now
+    EXPECT_EQ(log.get(), (std::vector<int>{1}));
+
+    scheduler.enqueue(milliseconds(5), [&] { log.add(2); });
+    scheduler.enqueue(milliseconds(0), [&] { log.add(3); }); // Waits behind step 2
+    EXPECT_EQ(log.get(), (std::vector<int>{1}));
+
+    while (log.get().size() < 3) {
+        ASSERT_TRUE(waitReadable(scheduler.fd()));
+        scheduler.dispatch();
+    }
+    EXPECT_EQ(log.get(), (std::vector<int>{1, 2, 3}));
+}
+
+TEST(InjectionSchedulerTest, DueStepWaitsForTheStepInFlight) {
+    InjectionScheduler scheduler;
+    ASSERT_TRUE(scheduler.initialize());
+    Log log;
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+
+    // The last queued step is running on the dispatch thread...
+    scheduler.enqueue(milliseconds(1), [&] {
+        started = true;
+        while (!release) std::this_thread::yield();
+        log.add(1);
+    });
+    std::thread dispatcher([&] {
+        while (log.get().size() < 2 && waitReadable(scheduler.fd())) scheduler.dispatch();
+    });
+    while (!started) std::this_thread::yield();
+
+    // ...so a step due now from another thread queues behind it instead of running.
+    scheduler.enqueue(milliseconds(0), [&] { log.add(2); });
+    EXPECT_TRUE(log.get().empty());
+
+    release = true;
+    dispatcher.join();
+    EXPECT_EQ(log.get(), (std::vector<int>{1, 2}));
+}
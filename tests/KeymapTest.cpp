@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "../src/core/Keymap.h"
+#include "../src/core/Config.h"
+#include <linux/input-event-codes.h>
+#include <X11/keysym.h>
+
+TEST(KeymapTest, DefaultsMatchTheBuiltInKeys) {
+    const Keymap keymap;
+    EXPECT_EQ(keymap.evdev(KEY_ESC).action, KeyAction::Deactivate);
+    EXPECT_EQ(keymap.evdev(KEY_SPACE).action, KeyAction::LeftClick);
+    EXPECT_EQ(keymap.evdev(KEY_ENTER).action, KeyAction::RightClick);
+    EXPECT_EQ(keymap.evdev(KEY_BACKSPACE).action, KeyAction::Undo);
+
+    // Every letter stays free to pick cells
+    EXPECT_EQ(keymap.evdev(KEY_DELETE).action, KeyAction::StayClick);
+    EXPECT_EQ(keymap.evdev(KEY_F).action, KeyAction::Unbound);
+    EXPECT_EQ(keymap.evdev(KEY_F).c, 'f');
+    EXPECT_EQ(keymap.evdev(KEY_A).c, 'a');
+    EXPECT_EQ(keymap.evdev(KEY_0).c, '0');
+    EXPECT_EQ(keymap.evdev(KEY_SEMICOLON).c, '\0');
+    EXPECT_EQ(keymap.evdev(KEY_ESC).c, '\0');
+
+    EXPECT_EQ(keymap.keysym(XK_Escape).action, KeyAction::Deactivate);
+    EXPECT_EQ(keymap.keysym(XK_Return).action, KeyAction::RightClick);
+    EXPECT_EQ(keymap.keysym(XK_Delete).action, KeyAction::StayClick);
+    EXPECT_EQ(keymap.keysym(XK_f).c, 'f');
+    EXPECT_EQ(keymap.keysym(XK_Q).c, 'q');
+    EXPECT_EQ(keymap.keysym(XK_7).c, '7');
+
+    EXPECT_EQ(keymap.evdev(KEY_TAB).action, KeyAction::Precision);
+    EXPECT_EQ(keymap.evdev(KEY_LEFT).action, KeyAction::MoveLeft);
+    EXPECT_EQ(keymap.evdev(KEY_DOWN).action, KeyAction::MoveDown);
+    EXPECT_EQ(keymap.keysym(XK_Up).action, KeyAction::MoveUp);
+    EXPECT_EQ(keymap.keysym(XK_Right).action, KeyAction::MoveRight);
+    EXPECT_EQ(keymap.evdev(KEY_LEFT).c, '\0');
+}
+
+TEST(KeymapTest, UnknownCodesAndKeysymsAreUnbound) {
+    const Keymap keymap;
+    for (unsigned long sym : {0ul, (unsigned long)XK_F1 + 0x10000, (unsigned long)XK_Greek_alpha, 0xffffff00ul}) {
+        EXPECT_EQ(keymap.keysym(sym).action, KeyAction::Unbound) << std::hex << sym;
+        EXPECT_EQ(keymap.keysym(sym).c, '\0') << std::hex << sym;
+    }
+    EXPECT_EQ(keymap.evdev(-1).action, KeyAction::Unbound);
+    EXPECT_EQ(keymap.evdev(Keymap::EVDEV_CODES).c, '\0');
+}
+
+TEST(KeymapTest, LayoutsRelabelKeyPositions) {
+    Keymap keymap;
+    ASSERT_TRUE(keymap.setLayout("dvorak"));
+    EXPECT_EQ(keymap.evdev(KEY_S).c, 'o');
+    EXPECT_EQ(keymap.evdev(KEY_Q).c, '\0'); // Apostrophe
+    EXPECT_EQ(keymap.evdev(KEY_SEMICOLON).c, 's');
+    ASSERT_TRUE(keymap.bind(KeyAction::StayClick, "f"));
+    // A letter binding follows the label to the Y position
+    EXPECT_EQ(keymap.evdev(KEY_Y).action, KeyAction::StayClick);
+    EXPECT_EQ(keymap.evdev(KEY_Y).c, '\0');
+    EXPECT_EQ(keymap.evdev(KEY_F).action, KeyAction::Unbound);
+
+    ASSERT_TRUE(keymap.setLayout("AZERTY"));
+    EXPECT_EQ(keymap.evdev(KEY_Q).c, 'a');
+    EXPECT_EQ(keymap.evdev(KEY_SEMICOLON).c, 'm');
+    EXPECT_EQ(keymap.evdev(KEY_M).c, '\0');
+    EXPECT_EQ(keymap.evdev(KEY_1).c, '1');
+
+    EXPECT_FALSE(keymap.setLayout("klingon"));
+    EXPECT_EQ(keymap.evdev(KEY_Q).c, 'a');
+}
+
+TEST(KeymapTest, ActionsCanBeRebound) {
+    Keymap keymap;
+    ASSERT_TRUE(keymap.bind(KeyAction::Deactivate, "q"));
+    ASSERT_TRUE(keymap.bind(KeyAction::Precision, "5")); // Frees Tab
+    ASSERT_TRUE(keymap.bind(KeyAction::LeftClick, "Tab"));
+    EXPECT_FALSE(keymap.bind(KeyAction::Undo, "hyper"));
+
+    EXPECT_EQ(keymap.evdev(KEY_ESC).action, KeyAction::Unbound);
+    EXPECT_EQ(keymap.evdev(KEY_Q).action, KeyAction::Deactivate);
+    EXPECT_EQ(keymap.evdev(KEY_Q).c, '\0');
+    EXPECT_EQ(keymap.keysym(XK_q).c, '\0');
+    EXPECT_EQ(keymap.keysym(XK_q).action, KeyAction::Deactivate);
+    EXPECT_EQ(keymap.keysym(XK_Q).action, KeyAction::Deactivate);
+    EXPECT_EQ(keymap.evdev(KEY_TAB).action, KeyAction::LeftClick);
+    EXPECT_EQ(keymap.keysym(XK_Tab).action, KeyAction::LeftClick);
+    EXPECT_EQ(keymap.evdev(KEY_SPACE).action, KeyAction::Unbound);
+    EXPECT_EQ(keymap.evdev(KEY_BACKSPACE).action, KeyAction::Undo);
+}
+
+TEST(KeymapTest, LoadCompilesConfig) {
+    Config::KEYBOARD_LAYOUT = "colemak";
+    Config::BIND_STAY_CLICK = "t";
+    Keymap::load();
+    EXPECT_EQ(Keymap::current().evdev(KEY_F).action, KeyAction::StayClick);
+    EXPECT_EQ(Keymap::current().evdev(KEY_F).c, '\0');
+    EXPECT_EQ(Keymap::current().evdev(KEY_E).c, 'f');
+
+    Config::KEYBOARD_LAYOUT = "qwerty";
+    Config::BIND_STAY_CLICK = "delete";
+    Keymap::load();
+    EXPECT_EQ(Keymap::current().evdev(KEY_DELETE).action, KeyAction::StayClick);
+    EXPECT_EQ(Keymap::current().evdev(KEY_F).c, 'f');
+    EXPECT_EQ(Keymap::current().evdev(KEY_T).c, 't');
+}
@@ -0,0 +1,68 @@
+#ifndef TESTS_MOCKS_H
+#define TESTS_MOCKS_H
+
+#include "../src/core/Platform.h"
+#include "../src/core/Input.h"
+#include "../src/core/Overlay.h"
+
+// In-memory backends shared by EngineTest and the trace replay tool.
+
+class MockPlatform : public Platform {
+public:
+    int screenW = 1920, screenH = 1080;
+    int cursorX = 0, cursorY = 0;
+    int clicks = 0;
+    bool frameTicks = false;
+    bool deferClicks = false; // Hold afterClick() steps in pendingSteps
+    std::vector<std::function<void()>> pendingSteps;
+
+    bool initialize() override { return true; }
+    void run() override {}
+    void exit() override {}
+    void releaseModifiers() override {}
+    void getScreenSize(int& w, int& h) override { w = screenW; h = screenH; }
+    void moveCursor(int x, int y) override { cursorX = x; cursorY = y; }
+    void clickMouse(int button, int count) override { clicks += count; }
+    void setFrameTicks(bool enabled) override { frameTicks = enabled; }
+    void afterClick(std::function<void()> step) override {
+        if (deferClicks) pendingSteps.push_back(std::move(step));
+        else step();
+    }
+};
+
+class MockOverlay : public Overlay {
+public:
+    int originX = 0, originY = 0; // Monitor position on the root window
+    int screenW = 1920, screenH = 1080;
+    int updates = 0;
+    bool isVisible = false;
+    bool lastShowPoint = false;
+    GridLayout lastLayout;
+    std::vector<GridLayout> prerendered;
+
+    void show() override { isVisible = true; }
+    void hide() override { isVisible = false; }
+    void updateGrid(const GridLayout& layout, bool showPoint) override {
+        updates++; 
+        lastShowPoint = showPoint;
+        lastLayout = layout;
+    }
+    void prerender(const std::vector<GridLayout>& candidates) override { prerendered = candidates; }
+    bool getBounds(Rect& out) override {
+        out = {(double)originX, (double)originY, (double)screenW, (double)screenH};
+        return true;
+    }
+};
+
+class MockInput : public Input {
+public:
+    bool grabbed = false;
+
+    bool initialize(int w, int h) override { return true; }
+    void grabKeyboard() override { grabbed = true; }
+    void ungrabKeyboard() override { grabbed = false; }
+    void moveMouse(int x, int y, int sw, int sh) override {}
+    void clickMouse(int button, int count) override {}
+};
+
+#endif // TESTS_MOCKS_H
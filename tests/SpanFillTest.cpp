@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "../src/render/SpanFill.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+const SpanFill::Impl ALL_IMPLS[] = {SpanFill::Impl::Scalar, SpanFill::Impl::Sse2, SpanFill::Impl::Avx2};
+
+// round(x * a / 255), which pixman's rounding computes exactly
+uint32_t mulRounded(uint32_t x, uint32_t a) {
+    return (x * a * 2 + 255) / 510;
+}
+
+} // namespace
+
+TEST(SpanFillTest, ScalarMatchesPixmanOver) {
+    // Every destination value under every non-opaque source alpha
+    for (uint32_t alpha = 0; alpha < 255; ++alpha) {
+        const uint32_t color = alpha << 24 | (alpha / 2) << 16 | (alpha / 3) << 8 | alpha / 4;
+        std::vector<uint32_t> pixels(256);
+        for (uint32_t x = 0; x < 256; ++x) pixels[x] = x * 0x01010101u;
+        SpanFill::fillOver(SpanFill::Impl::Scalar, pixels.data(), 256, color);
+
+        for (uint32_t x = 0; x < 256; ++x) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                const uint32_t expected = std::min(255u, ((color >> shift) & 0xff) + mulRounded(x, 255 - alpha));
+                ASSERT_EQ((pixels[x] >> shift) & 0xff, expected) << "alpha " << alpha << " dst " << x;
+            }
+        }
+    }
+}
+
+TEST(SpanFillTest, SimdVariantsMatchScalar) {
+    std::mt19937 rng(7);
+    for (SpanFill::Impl impl : ALL_IMPLS) {
+        if (!SpanFill::supported(impl)) continue;
+
+        for (int count = 0; count < 70; ++count) {
+            for (int start = 0; start < 4; ++start) {
+                // Premultiplied source and destination, so channels never exceed alpha
+                const uint32_t alpha = rng() % 255;
+                const uint32_t color = alpha << 24 | (rng() % (alpha + 1)) << 16 |
+                                       (rng() % (alpha + 1)) << 8 | rng() % (alpha + 1);
+                std::vector<uint32_t> expected(count + start + 1);
+                for (uint32_t& pixel : expected) {
+                    const uint32_t a = rng() % 256;
+                    pixel = a << 24 | (rng() % (a + 1)) << 16 | (rng() % (a + 1)) << 8 | rng() % (a + 1);
+                }
+                std::vector<uint32_t> actual = expected;
+
+                SpanFill::fillOver(SpanFill::Impl::Scalar, expected.data() + start, count, color);
+                SpanFill::fillOver(impl, actual.data() + start, count, color);
+                ASSERT_EQ(actual, expected) << SpanFill::name(impl) << " count " << count << " start " << start;
+            }
+        }
+    }
+}
+
+TEST(SpanFillTest, OpaqueAndTransparentColours) {
+    std::vector<uint32_t> pixels(9, 0x80402010u);
+    SpanFill::fillOver(pixels.data() + 1, 7, 0xff336699u);
+    EXPECT_EQ(pixels[0], 0x80402010u);
+    for (int i = 1; i < 8; ++i) EXPECT_EQ(pixels[i], 0xff336699u);
+    EXPECT_EQ(pixels[8], 0x80402010u);
+
+    SpanFill::fillOver(pixels.data(), 9, 0u);
+    EXPECT_EQ(pixels[0], 0x80402010u);
+}
+
+TEST(SpanFillTest, PremultipliesLikeCairo) {
+    EXPECT_EQ(SpanFill::premultiply(1.0, 1.0, 1.0, 1.0), 0xffffffffu);
+    EXPECT_EQ(SpanFill::premultiply(1.0, 0.0, 0.5, 0.0), 0u);
+    // 0.30 * 65535 + 0.5 = 19661 -> 0x4c; 0.5 * 0.30 -> 9830.75 -> 0x26
+    EXPECT_EQ(SpanFill::premultiply(1.0, 0.5, 0.0, 0.30), 0x4c4c2600u);
+    EXPECT_EQ(SpanFill::premultiply(2.0, -1.0, 0.0, 1.0), 0xffff0000u);
+}
@@ -0,0 +1,50 @@
+// Replays a session recorded with `KeyNav --record <path>` through the Engine
+// and mock backends, reporting throughput, latency and cursor divergence.
+//
+// Usage: TraceReplay <trace> [--passes N]
+// Exit status is non-zero when the replayed cursor output diverges.
+
+#include "TraceReplayer.h"
+#include "../src/core/Logger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <trace> [--passes N]\n", argv[0]);
+        return 2;
+    }
+
+    int passes = 1;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--passes") == 0 && i + 1 < argc) {
+            passes = std::max(1, std::atoi(argv[++i]));
+        }
+    }
+
+    // Engine logs every click; keep that out of the measurement.
+    Logger::getInstance().setLevel(LogLevel::WARNING);
+
+    TraceHeader header;
+    std::vector<ReplayStep> steps;
+    if (!loadTrace(argv[1], header, steps)) return 2;
+
+    const ReplayReport report = replayTrace(header, steps, passes);
+
+    std::printf("trace:       %s (%ux%u, grid %ux%u/%ux%u, depth %u)\n", argv[1],
+                header.screenW, header.screenH, header.level0Rows, header.level0Cols,
+                header.level1Rows, header.level1Cols, header.maxRecursionDepth);
+    std::printf("events:      %zu (%zu per pass, %d passes)\n", report.events, steps.size(), passes);
+    std::printf("throughput:  %.0f events/s\n", report.eventsPerSecond);
+    std::printf("latency ns:  p50 %llu  p90 %llu  p99 %llu  max %llu\n",
+                (unsigned long long)report.p50Ns, (unsigned long long)report.p90Ns,
+                (unsigned long long)report.p99Ns, (unsigned long long)report.maxNs);
+    if (report.divergentEvents == 0) {
+        std::printf("divergence:  none\n");
+        return 0;
+    }
+
+    std::printf("divergence:  %zu events, first at #%ld\n", report.divergentEvents, report.firstDivergence);
+    return 1;
+}
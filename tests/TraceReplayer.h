@@ -0,0 +1,125 @@
+#ifndef TESTS_TRACE_REPLAYER_H
+#define TESTS_TRACE_REPLAYER_H
+
+#include "../src/core/Engine.h"
+#include "../src/core/Trace.h"
+#include "Mocks.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Feeds a recorded trace back through a fresh Engine wired to the mocks and
+// compares the cursor moves it produces against the recorded ones.
+
+struct ReplayStep {
+    EngineEvent event;
+    std::vector<std::pair<int, int>> expectedCursor;
+    bool hasBounds = false; // Activations carry the geometry they settled on
+    int screenW = 0, screenH = 0;
+    Rect overlayBounds = {0.0, 0.0, 0.0, 0.0};
+};
+
+struct ReplayReport {
+    size_t events = 0;           // Input events dispatched (all passes)
+    double seconds = 0.0;        // Wall time spent inside Engine::dispatch
+    double eventsPerSecond = 0.0;
+    uint64_t p50Ns = 0, p90Ns = 0, p99Ns = 0, maxNs = 0;
+    size_t divergentEvents = 0;  // Events whose cursor output differed (first pass)
+    long firstDivergence = -1;   // Index of the first such event, -1 if none
+};
+
+class RecordingPlatform : public MockPlatform {
+public:
+    std::vector<std::pair<int, int>> moves;
+    void moveCursor(int x, int y) override {
+        MockPlatform::moveCursor(x, y);
+        moves.emplace_back(x, y);
+    }
+};
+
+inline bool loadTrace(const std::string& path, TraceHeader& header, std::vector<ReplayStep>& steps) {
+    TraceReader reader;
+    if (!reader.open(path)) return false;
+    header = reader.header();
+
+    steps.clear();
+    TraceRecord record;
+    while (reader.next(record)) {
+        if (!record.isCursor && !record.isBounds) {
+            steps.push_back({record.event, {}});
+        } else if (record.isBounds && !steps.empty()) {
+            ReplayStep& step = steps.back();
+            step.hasBounds = true;
+            step.screenW = record.screenW;
+            step.screenH = record.screenH;
+            step.overlayBounds = record.overlayBounds;
+        } else if (!steps.empty()) {
+            steps.back().expectedCursor.emplace_back(record.cursorX, record.cursorY);
+        }
+    }
+    return true;
+}
+
+inline ReplayReport replayTrace(const TraceHeader& header, const std::vector<ReplayStep>& steps, int passes = 1) {
+    header.applyToConfig();
+
+    ReplayReport report;
+    std::vector<uint64_t> latencies;
+    latencies.reserve(steps.size() * (size_t)std::max(passes, 1));
+
+    for (int pass = 0; pass < passes; ++pass) {
+        Engine engine;
+        RecordingPlatform platform;
+        MockOverlay overlay;
+        MockInput input;
+        platform.screenW = overlay.screenW = (int)header.screenW;
+        platform.screenH = overlay.screenH = (int)header.screenH;
+        engine.setPlatform(&platform);
+        engine.setOverlay(&overlay);
+        engine.setInput(&input);
+        engine.initialize();
+
+        for (size_t i = 0; i < steps.size(); ++i) {
+            platform.moves.clear();
+            if (steps[i].hasBounds) {
+                const Rect& bounds = steps[i].overlayBounds;
+                platform.screenW = steps[i].screenW;
+                platform.screenH = steps[i].screenH;
+                overlay.originX = (int)bounds.x;
+                overlay.originY = (int)bounds.y;
+                overlay.screenW = (int)bounds.w;
+                overlay.screenH = (int)bounds.h;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            engine.dispatch(steps[i].event);
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            latencies.push_back((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+            if (pass == 0 && platform.moves != steps[i].expectedCursor) {
+                report.divergentEvents++;
+                if (report.firstDivergence < 0) report.firstDivergence = (long)i;
+            }
+        }
+    }
+
+    report.events = latencies.size();
+    if (latencies.empty()) return report;
+
+    uint64_t totalNs = 0;
+    for (uint64_t ns : latencies) totalNs += ns;
+    report.seconds = totalNs / 1e9;
+    report.eventsPerSecond = report.seconds > 0 ? report.events / report.seconds : 0.0;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies[(size_t)(p * (latencies.size() - 1))]; };
+    report.p50Ns = percentile(0.50);
+    report.p90Ns = percentile(0.90);
+    report.p99Ns = percentile(0.99);
+    report.maxNs = latencies.back();
+    return report;
+}
+
+#endif // TESTS_TRACE_REPLAYER_H
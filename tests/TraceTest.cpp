@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "../src/core/Config.h"
+#include "TraceReplayer.h"
+#include <cstdio>
+#include <unistd.h>
+
+class TraceTest : public ::testing::Test {
+protected:
+    std::string path;
+
+    void SetUp() override {
+        Config::LEVEL0_GRID_ROWS = 10;
+        Config::LEVEL0_GRID_COLS = 10;
+        Config::LEVEL1_GRID_ROWS = 5;
+        Config::LEVEL1_GRID_COLS = 5;
+        Config::MAX_RECURSION_DEPTH = 1;
+        path = ::testing::TempDir() + "keynav_trace_" + std::to_string(getpid()) + ".bin";
+    }
+
+    void TearDown() override { std::remove(path.c_str()); }
+
+    static EngineEvent event(EngineEventType type, char c = '\0') {
+        EngineEvent e;
+        e.type = type;
+        e.c = c;
+        return e;
+    }
+
+    // Records a short session: select a cell, refine, tap-release, then click.
+    // The grid covers a 1920x1080 monitor whose left edge is at `originX`.
+    void recordSession(int originX = 0) {
+        Engine engine;
+        MockPlatform platform;
+        MockOverlay overlay;
+        MockInput input;
+        overlay.originX = originX;
+        TraceWriter writer;
+        ASSERT_TRUE(writer.open(path, TraceHeader::fromConfig(1920, 1080)));
+        engine.setPlatform(&platform);
+        engine.setOverlay(&overlay);
+        engine.setInput(&input);
+        engine.setRecorder(&writer);
+        engine.initialize();
+
+        engine.dispatch(event(EngineEventType::Activate));
+        engine.dispatch(event(EngineEventType::Char, 'b'));
+        engine.dispatch(event(EngineEventType::Char, 'c'));
+        engine.dispatch(event(EngineEventType::Char, 'e'));
+        engine.dispatch(event(EngineEventType::CharRelease, 'e'));
+        engine.dispatch(event(EngineEventType::Activate));
+
+        EngineEvent click = event(EngineEventType::Click);
+        click.button = 1;
+        click.count = 2;
+        click.deactivate = true;
+        engine.dispatch(click);
+        writer.close();
+    }
+};
+
+TEST_F(TraceTest, RoundTripsEventsAndCursorMoves) {
+    recordSession();
+
+    TraceReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.header().screenW, 1920u);
+    EXPECT_EQ(reader.header().level1Cols, 5u);
+
+    std::vector<TraceRecord> records;
+    TraceRecord record;
+    uint64_t lastNs = 0;
+    while (reader.next(record)) {
+        EXPECT_GE(record.timeNs, lastNs);
+        lastNs = record.timeNs;
+        records.push_back(record);
+    }
+
+    ASSERT_GE(records.size(), 5u);
+    EXPECT_EQ(records[0].event.type, EngineEventType::Activate);
+    ASSERT_TRUE(records[1].isBounds);
+    EXPECT_EQ(records[1].screenW, 1920);
+    EXPECT_EQ(records[1].overlayBounds.h, 1080.0);
+    EXPECT_EQ(records[2].event.type, EngineEventType::Char);
+    EXPECT_EQ(records[2].event.c, 'b');
+    // The click re-centres the cursor, so its record is followed by one move.
+    ASSERT_TRUE(records.back().isCursor);
+    const EngineEvent& click = records[records.size() - 2].event;
+    EXPECT_EQ(click.type, EngineEventType::Click);
+    EXPECT_EQ(click.count, 2);
+    EXPECT_TRUE(click.deactivate);
+
+    // The second character selects a Level0 cell and moves the cursor there.
+    EXPECT_TRUE(records[4].isCursor);
+    EXPECT_EQ(records[4].cursorX, 2 * 192 + 96);
+}
+
+TEST_F(TraceTest, ReplayMatchesRecording) {
+    recordSession();
+
+    TraceHeader header;
+    std::vector<ReplayStep> steps;
+    ASSERT_TRUE(loadTrace(path, header, steps));
+    ASSERT_EQ(steps.size(), 7u);
+
+    const ReplayReport report = replayTrace(header, steps, 3);
+    EXPECT_EQ(report.events, 21u);
+    EXPECT_EQ(report.divergentEvents, 0u);
+    EXPECT_LE(report.p50Ns, report.p99Ns);
+}
+
+TEST_F(TraceTest, ReplayReportsDivergence) {
+    recordSession();
+
+    TraceHeader header;
+    std::vector<ReplayStep> steps;
+    ASSERT_TRUE(loadTrace(path, header, steps));
+
+    header.level0Cols = 8; // Simulates a behavioural change in cell selection
+    const ReplayReport report = replayTrace(header, steps);
+    EXPECT_GT(report.divergentEvents, 0u);
+    EXPECT_EQ(report.firstDivergence, 2);
+}
+
+TEST_F(TraceTest, ReplayUsesRecordedMonitorBounds) {
+    recordSession(1920); // The right-hand monitor of a side-by-side pair
+
+    TraceHeader header;
+    std::vector<ReplayStep> steps;
+    ASSERT_TRUE(loadTrace(path, header, steps));
+    ASSERT_TRUE(steps[0].hasBounds);
+    EXPECT_EQ(steps[0].overlayBounds.x, 1920.0);
+    ASSERT_EQ(steps[2].expectedCursor.size(), 1u);
+    EXPECT_EQ(steps[2].expectedCursor[0].first, 1920 + 2 * 192 + 96);
+
+    EXPECT_EQ(replayTrace(header, steps).divergentEvents, 0u);
+
+    // Without the bounds the grid lands on the left-hand monitor
+    for (ReplayStep& step : steps) step.hasBounds = false;
+    EXPECT_GT(replayTrace(header, steps).divergentEvents, 0u);
+}
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Usage: run_headless_sway.sh <sway> <test binary> [args...]
+# Starts sway on the headless wlroots backend in a private runtime dir, runs
+# the test against it and stops sway again.
+set -u
+SWAY="$1"
+shift
+
+RUNTIME_DIR=$(mktemp -d)
+chmod 700 "$RUNTIME_DIR"
+CONFIG="$RUNTIME_DIR/config"
+: > "$CONFIG"
+
+XDG_RUNTIME_DIR="$RUNTIME_DIR" WLR_BACKENDS=headless WLR_HEADLESS_OUTPUTS=1 WLR_LIBINPUT_NO_DEVICES=1 WLR_RENDERER=pixman \
+    WAYLAND_DISPLAY= "$SWAY" --config "$CONFIG" > "$RUNTIME_DIR/sway.log" 2>&1 &
+SWAY_PID=$!
+
+# Wait up to five seconds for the Wayland socket.
+SOCKET=""
+for _ in $(seq 50); do
+    SOCKET=$(cd "$RUNTIME_DIR" && ls wayland-* 2>/dev/null | grep -v '\.lock$' | head -n 1)
+    [ -n "$SOCKET" ] && break
+    sleep 0.1
+done
+
+if [ -z "$SOCKET" ]; then
+    echo "headless sway did not start:" >&2
+    cat "$RUNTIME_DIR/sway.log" >&2
+    kill "$SWAY_PID" 2>/dev/null
+    rm -rf "$RUNTIME_DIR"
+    exit 1
+fi
+
+XDG_RUNTIME_DIR="$RUNTIME_DIR" WAYLAND_DISPLAY="$SOCKET" "$@"
+STATUS=$?
+
+kill "$SWAY_PID" 2>/dev/null
+wait "$SWAY_PID" 2>/dev/null
+rm -rf "$RUNTIME_DIR"
+exit $STATUS